@@ -4,6 +4,7 @@
 #include <sstream>
 #include <algorithm>
 #include <iomanip> // for std::fixed and std::setprecision
+#include <cstdint>
 
 using namespace std;
 
@@ -27,43 +28,122 @@ public:
 };
 
 
-class Theater {
+// Bitset view over one show's seats: one bit per seat, set while the seat is free.
+// The bits themselves live in the ShowInventory pool.
+class SeatBitmap {
 private:
-    vector<int> availableSeats;
+    uint64_t* words;
+    int totalSeats;
 
 public:
-    Theater(int totalSeats) {
-        for (int i = 1; i <= totalSeats; ++i) {
-            availableSeats.push_back(i);
+    SeatBitmap(uint64_t* w, int seatCount) : words(w), totalSeats(seatCount) {}
+
+    static size_t wordCount(int seatCount) {
+        return (seatCount + 63) / 64;
+    }
+
+    // Marks every seat free and clears the unused bits past the last seat
+    void reset() {
+        size_t count = wordCount(totalSeats);
+        fill(words, words + count, ~0ULL);
+        if (totalSeats % 64 != 0) {
+            words[count - 1] = (1ULL << (totalSeats % 64)) - 1;
         }
     }
 
-    void displayAvailableSeats(const string& timing) {
-        cout << "Available seats for timing " << timing << ": ";
-        for (int seat : availableSeats) {
-            cout << seat << " ";
+    bool validSeat(int seat) const {
+        return seat >= 1 && seat <= totalSeats;
+    }
+
+    // Marks the seat as taken, returns false if it was already taken
+    bool claim(int seat) {
+        int index = seat - 1;
+        uint64_t mask = 1ULL << (index & 63);
+        uint64_t& word = words[index >> 6];
+        if (!(word & mask)) return false;
+        word &= ~mask;
+        return true;
+    }
+
+    void release(int seat) {
+        int index = seat - 1;
+        words[index >> 6] |= 1ULL << (index & 63);
+    }
+
+    // Calls fn(seatNumber) for every free seat, skipping taken ones word by word
+    template <typename Fn>
+    void forEachFree(Fn fn) const {
+        for (size_t w = 0; w < wordCount(totalSeats); ++w) {
+            uint64_t word = words[w];
+            while (word) {
+                fn(static_cast<int>(w * 64 + __builtin_ctzll(word)) + 1);
+                word &= word - 1;
+            }
         }
+    }
+};
+
+// Seat inventory for every show (movie + timing), packed into one contiguous pool.
+// Each show's seat map starts on its own 64-byte line.
+class ShowInventory {
+private:
+    struct ShowSlot {
+        size_t offset;
+        int totalSeats;
+    };
+
+    static const size_t wordsPerLine = 8;
+
+    vector<uint64_t> pool;
+    vector<ShowSlot> shows;
+
+public:
+    // Allocates a fresh seat map and returns its show id
+    int addShow(int totalSeats) {
+        size_t words = SeatBitmap::wordCount(totalSeats);
+        words = (words + wordsPerLine - 1) / wordsPerLine * wordsPerLine;
+        ShowSlot slot = {pool.size(), totalSeats};
+        pool.resize(pool.size() + words, 0);
+        shows.push_back(slot);
+        seats(shows.size() - 1).reset();
+        return shows.size() - 1;
+    }
+
+    SeatBitmap seats(int showId) {
+        const ShowSlot& slot = shows[showId];
+        return SeatBitmap(&pool[slot.offset], slot.totalSeats);
+    }
+
+    void displayAvailableSeats(int showId, const string& timing) {
+        cout << "Available seats for timing " << timing << ": ";
+        seats(showId).forEachFree([](int seat) { cout << seat << " "; });
         cout << endl;
     }
 
-    bool bookSeats(const string& timing, const vector<int>& seatNumbers) {
-        for (int seat : seatNumbers) {
-            if (find(availableSeats.begin(), availableSeats.end(), seat) == availableSeats.end()) {
-                return false; 
+    bool bookSeats(int showId, const vector<int>& seatNumbers) {
+        SeatBitmap map = seats(showId);
+        for (size_t i = 0; i < seatNumbers.size(); ++i) {
+            int seat = seatNumbers[i];
+            if (!map.validSeat(seat) || !map.claim(seat)) {
+                // Roll back the seats claimed so far
+                for (size_t j = 0; j < i; ++j) {
+                    map.release(seatNumbers[j]);
+                }
+                return false;
             }
         }
-       
-        for (int seat : seatNumbers) {
-            availableSeats.erase(remove(availableSeats.begin(), availableSeats.end(), seat), availableSeats.end());
-        }
-        return true; 
+        return true;
     }
 
-    bool cancelSeats(const string& timing, const vector<int>& seatNumbers) {
+    bool cancelSeats(int showId, const vector<int>& seatNumbers) {
+        SeatBitmap map = seats(showId);
         for (int seat : seatNumbers) {
-            availableSeats.push_back(seat); 
+            if (!map.validSeat(seat)) return false;
         }
-        return true; 
+        for (int seat : seatNumbers) {
+            map.release(seat);
+        }
+        return true;
     }
 };
 
@@ -139,16 +219,27 @@ public:
 // Class for managing the entire booking system
 class BookingSystem {
 private:
-    vector<Movie> movies;
-    Theater theater;
+    vector<Movie> movies; // Show id == index in movies
+    ShowInventory inventory;
     vector<Ticket> bookedTickets;
 
-public:
-    BookingSystem() : theater(50) {} // Assuming the theater has 50 seats
+    static const int seatsPerShow = 50; // Assuming every show has 50 seats
+
+    // Returns the show id for a movie and timing, or -1 if there is no such show
+    int findShow(const string& movieTitle, const string& timing) const {
+        for (size_t i = 0; i < movies.size(); ++i) {
+            if (movies[i].title == movieTitle && movies[i].timing == timing) {
+                return i;
+            }
+        }
+        return -1;
+    }
 
-    // Add a movie to the system
+public:
+    // Add a movie to the system, with its own seat map
     void addMovie(const Movie& movie) {
         movies.push_back(movie);
+        inventory.addShow(seatsPerShow);
     }
 
     // Show movies sorted by timing
@@ -165,40 +256,30 @@ public:
 
     // Check currently available seats for a movie and timing
     bool checkAvailableSeats(const string& movieTitle, const string& timing) {
-        bool movieFound = false;
-        for (const auto& movie : movies) {
-            if (movie.title == movieTitle && movie.timing == timing) {
-                movieFound = true;
-                theater.displayAvailableSeats(timing);
-                return true;
-            }
-        }
-        if (!movieFound) {
+        int showId = findShow(movieTitle, timing);
+        if (showId < 0) {
             cout << "Movie not found or invalid timing.\nPlease check movie details." << endl;
             return false;
         }
+        inventory.displayAvailableSeats(showId, timing);
+        return true;
     }
 
     // Book tickets
     void bookTicket(const string& customerName, const string& mobileNumber, const string& movieTitle, const string& timing, const vector<int>& seatNumbers) {
-        bool movieFound = false;
-        for (const auto& movie : movies) {
-            if (movie.title == movieTitle && movie.timing == timing) {
-                movieFound = true;
-                double totalPrice = seatNumbers.size() * movie.price; //
-                if (theater.bookSeats(timing, seatNumbers)) {
-                    Ticket ticket(customerName, mobileNumber, movieTitle, timing, seatNumbers, totalPrice);
-                    bookedTickets.push_back(ticket);
-                    cout << "Ticket(s) booked successfully!\n";
-                    ticket.displayTicket();
-                } else {
-                    cout << "Failed to book ticket(s): Some seats are unavailable or invalid.\n";
-                }
-                return;
-            }
-        }
-        if (!movieFound) {
+        int showId = findShow(movieTitle, timing);
+        if (showId < 0) {
             cout << "Movie not found or invalid timing.\nPlease check movie details." << endl;
+            return;
+        }
+        double totalPrice = seatNumbers.size() * movies[showId].price;
+        if (inventory.bookSeats(showId, seatNumbers)) {
+            Ticket ticket(customerName, mobileNumber, movieTitle, timing, seatNumbers, totalPrice);
+            bookedTickets.push_back(ticket);
+            cout << "Ticket(s) booked successfully!\n";
+            ticket.displayTicket();
+        } else {
+            cout << "Failed to book ticket(s): Some seats are unavailable or invalid.\n";
         }
     }
 
@@ -216,15 +297,10 @@ public:
                     }
                 }
                 if (allSeatsFound) {
-                    if (theater.cancelSeats(timing, seatNumbers)) {
+                    int showId = findShow(movieTitle, timing);
+                    if (showId >= 0 && inventory.cancelSeats(showId, seatNumbers)) {
                         // Update the total price after cancellation
-                        double pricePerSeat = 0.0; // Initialize price per seat
-                        for (const auto& movie : movies) {
-                            if (movie.title == movieTitle && movie.timing == timing) {
-                                pricePerSeat = movie.price; // Get the price for the movie
-                                break;
-                            }
-                        }
+                        double pricePerSeat = movies[showId].price;
 
                         // Remove canceled seat numbers from the ticket
                         for (int seatNumber : seatNumbers) {
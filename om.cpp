@@ -1,40 +1,2166 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <algorithm>
 #include <iomanip> // for std::fixed and std::setprecision
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <tuple>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <cstdio>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
+// Minutes since midnight for a timing such as "10:00 AM", "1:00 PM" or "19:30",
+// or -1 if the timing cannot be read. A leading "YYYY-MM-DD " date, as imported
+// schedules carry, is skipped.
+int parseTiming(string_view timing)
+{
+    if (timing.size() > 11 && timing[4] == '-' && timing[7] == '-' && timing[10] == ' ')
+        timing.remove_prefix(11);
+    size_t i = 0;
+    int hours = 0, minutes = 0, digits = 0;
+    while (i < timing.size() && isdigit((unsigned char)timing[i]) && digits < 2)
+    {
+        hours = hours * 10 + (timing[i++] - '0');
+        digits++;
+    }
+    if (digits == 0 || i + 3 > timing.size() || timing[i] != ':' ||
+        !isdigit((unsigned char)timing[i + 1]) || !isdigit((unsigned char)timing[i + 2]))
+        return -1;
+    minutes = (timing[i + 1] - '0') * 10 + (timing[i + 2] - '0');
+    i += 3;
+    while (i < timing.size() && timing[i] == ' ')
+        i++;
+
+    if (i == timing.size())
+        return (hours < 24 && minutes < 60) ? hours * 60 + minutes : -1; // 24-hour clock
+    if (i + 2 != timing.size() || toupper(timing[i + 1]) != 'M' || hours < 1 || hours > 12 || minutes >= 60)
+        return -1;
+    char half = toupper(timing[i]);
+    if (half != 'A' && half != 'P')
+        return -1;
+    return ((hours % 12) + (half == 'P' ? 12 : 0)) * 60 + minutes;
+}
+
+// Shows grouped by start minute, so listing them in time order needs no sort.
+// There is one bucket per minute of the day plus a last one for timings that
+// could not be read, and a bitmap of the buckets in use.
+class ScheduleIndex
+{
+private:
+    static const int buckets = 24 * 60 + 1;
+    vector<vector<int>> byMinute; // Positions of the shows, in the order they were added
+    uint64_t used[(buckets + 63) / 64] = {};
+
+public:
+    ScheduleIndex() : byMinute(buckets) {}
+
+    void insert(int startMinute, int position)
+    {
+        int bucket = startMinute < 0 ? buckets - 1 : startMinute;
+        byMinute[bucket].push_back(position);
+        used[bucket / 64] |= 1ULL << (bucket % 64);
+    }
+
+    // Calls fn(position) for every show, earliest first
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        for (int w = 0; w < (buckets + 63) / 64; w++)
+        {
+            uint64_t word = used[w];
+            while (word)
+            {
+                for (int position : byMinute[w * 64 + __builtin_ctzll(word)])
+                {
+                    fn(position);
+                }
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+// Spreads the bits of an integer key for open-addressing tables (splitmix64 finaliser)
+inline size_t mixHash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    return key ^ (key >> 33);
+}
+
+// Id of a string in the global symbol table
+typedef uint32_t Symbol;
+
+// Global symbol table: every distinct title, timing and customer name is
+// stored once and referred to by a 32-bit id, so comparing two of them
+// is an integer compare. Lookups of known strings go through an open-addressing
+// table and never allocate.
+class SymbolTable
+{
+private:
+    vector<string> strings;
+    vector<Symbol> slots; // Symbol + 1, 0 = empty; size is a power of two
+    size_t textBytes = 0;
+
+    static uint64_t hashOf(string_view s)
+    {
+        uint64_t h = 14695981039346656037ULL; // FNV-1a
+        for (unsigned char c : s)
+        {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // Slot holding s, or the empty slot where it would go
+    size_t probe(string_view s) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = hashOf(s) & mask;
+        while (slots[i] != 0 && strings[slots[i] - 1] != s)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        slots.assign(max<size_t>(16, slots.size() * 2), 0);
+        for (size_t id = 0; id < strings.size(); id++)
+        {
+            slots[probe(strings[id])] = id + 1;
+        }
+    }
+
+public:
+    static const Symbol none = ~0u;
+
+    // Id of s, or none if it was never interned
+    Symbol find(string_view s) const
+    {
+        if (slots.empty())
+            return none;
+        return slots[probe(s)] - 1;
+    }
+
+    Symbol intern(string_view s)
+    {
+        if ((strings.size() + 1) * 2 > slots.size())
+            grow();
+        size_t i = probe(s);
+        if (slots[i] == 0)
+        {
+            strings.emplace_back(s);
+            slots[i] = strings.size();
+            textBytes += strings.back().capacity() > 15 ? strings.back().capacity() + 1 : 0; // Heap part, beyond the inline buffer
+        }
+        return slots[i] - 1;
+    }
+
+    const string &str(Symbol id) const { return strings[id]; }
+
+    size_t size() const { return strings.size(); }
+
+    // Bytes held by the table: the strings, their text and the hash slots
+    size_t memoryUsage() const
+    {
+        return strings.capacity() * sizeof(string) + textBytes + slots.capacity() * sizeof(Symbol);
+    }
+};
+
+SymbolTable symbols;
+
+// A 10 digit mobile number packed into an integer. Validation and packing
+// run on 8 digits at a time inside a 64-bit word (SWAR), so checking a
+// number is a few arithmetic ops with no per-character branches. Assumes a
+// little-endian target.
+class PhoneKey
+{
+private:
+    uint64_t value;
+
+    // True if all 8 bytes of chunk are ASCII digits
+    static bool eightDigits(uint64_t chunk)
+    {
+        return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+                (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+    }
+
+    // The 8 digits in chunk as a number, first character most significant
+    static uint32_t eightDigitValue(uint64_t chunk)
+    {
+        chunk = (chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+        chunk = (chunk & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+        return uint32_t((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+    }
+
+public:
+    static const uint64_t invalid = ~0ULL;
+
+    PhoneKey() : value(invalid) {}
+    explicit PhoneKey(string_view mobile) : value(parse(mobile.data(), mobile.size())) {}
+
+    // The number in text[0..length), or invalid unless it is exactly 10 digits
+    static uint64_t parse(const char *text, size_t length)
+    {
+        if (length != 10)
+            return invalid;
+        uint64_t chunk;
+        memcpy(&chunk, text, 8);
+        unsigned d8 = (unsigned char)text[8] - '0', d9 = (unsigned char)text[9] - '0';
+        if (!eightDigits(chunk) || d8 > 9 || d9 > 9)
+            return invalid;
+        return uint64_t(eightDigitValue(chunk)) * 100 + d8 * 10 + d9;
+    }
+
+    bool valid() const { return value != invalid; }
+    uint64_t packed() const { return value; }
+
+    // Back to the 10 digit text, keeping leading zeros
+    string str() const
+    {
+        if (!valid())
+            return "";
+        string text(10, '0');
+        uint64_t rest = value;
+        for (int i = 9; i >= 0; i--)
+        {
+            text[i] = '0' + rest % 10;
+            rest /= 10;
+        }
+        return text;
+    }
+
+    bool operator==(const PhoneKey &other) const { return value == other.value; }
+    bool operator!=(const PhoneKey &other) const { return value != other.value; }
+};
+
+// Console output formatted into one reusable buffer and handed to the stream in
+// a single write per request. Numbers go through to_chars and money is printed
+// from whole cents, so nothing touches the stream's format flags or flushes it
+// line by line.
+class OutputBuffer
+{
+private:
+    string text;
+
+public:
+    OutputBuffer &operator<<(string_view s)
+    {
+        text.append(s);
+        return *this;
+    }
+
+    OutputBuffer &operator<<(char c)
+    {
+        text.push_back(c);
+        return *this;
+    }
+
+    OutputBuffer &operator<<(long long n)
+    {
+        char digits[24];
+        text.append(digits, to_chars(digits, digits + sizeof(digits), n).ptr);
+        return *this;
+    }
+
+    OutputBuffer &operator<<(int n) { return *this << (long long)n; }
+
+    // 10 digits, keeping leading zeros
+    OutputBuffer &operator<<(PhoneKey mobile)
+    {
+        if (!mobile.valid())
+            return *this;
+        char digits[10];
+        uint64_t rest = mobile.packed();
+        for (int i = 9; i >= 0; i--)
+        {
+            digits[i] = '0' + rest % 10;
+            rest /= 10;
+        }
+        text.append(digits, 10);
+        return *this;
+    }
+
+    // Amount with two decimals, as fixed << setprecision(2) would print it
+    OutputBuffer &money(double amount)
+    {
+        long long cents = llround(amount * 100);
+        if (cents < 0)
+        {
+            text.push_back('-');
+            cents = -cents;
+        }
+        *this << cents / 100 << '.';
+        text.push_back('0' + cents % 100 / 10);
+        text.push_back('0' + cents % 10);
+        return *this;
+    }
+
+    size_t size() const { return text.size(); }
+
+    // Drops what has been formatted so far
+    void clear() { text.clear(); }
+
+    // Hands everything to the stream in one write and keeps the capacity. The
+    // stream flushes when it next reads input (cout is tied to cin) or exits.
+    void flush(ostream &out = cout)
+    {
+        out.write(text.data(), text.size());
+        text.clear();
+    }
+};
+
+OutputBuffer screen;
+
 // Class for a Movie
 class Movie
 {
 public:
-    string title;
-    string genre;
+    Symbol title;
+    Symbol genre;
     int duration; // in minutes
-    string timing;
+    Symbol timing;
+    int startMinute; // timing as minutes since midnight, -1 if unreadable
     double price;
 
-    Movie(string t, string g, int d, string time, double p)
-        : title(t), genre(g), duration(d), timing(time), price(p) {}
+    Movie(const string &t, const string &g, int d, const string &time, double p)
+        : title(symbols.intern(t)), genre(symbols.intern(g)), duration(d), timing(symbols.intern(time)),
+          startMinute(parseTiming(time)), price(p) {}
+
+    Movie(Symbol t, Symbol g, int d, Symbol time, int start, double p)
+        : title(t), genre(g), duration(d), timing(time), startMinute(start), price(p) {}
+
+    void displayMovieDetails(OutputBuffer &out = screen) const
+    {
+        out << "Title: " << symbols.str(title) << ", Genre: " << symbols.str(genre)
+            << ", Duration: " << duration << " min, Timing: " << symbols.str(timing) << ", Price: $";
+        out.money(price) << '\n';
+    }
+};
+
+// Seat geometry of one hall, shared by every show that plays in it. The hall is
+// a grid of rows and columns; positions that are aisles or gaps hold no seat.
+// Seats are numbered 1..seatCount() row by row, skipping the gaps, and every
+// row of the plane starts on a new 64-bit word.
+class HallLayout
+{
+private:
+    string hallName;
+    int rows, columns;
+    size_t wordsPerRow;
+    vector<uint64_t> seatPlane;    // One bit per grid position, set where there is a seat
+    vector<uint32_t> seatPosition; // Seat number - 1 -> bit position in the plane
+    vector<int> rowFirstSeat;      // Number of the first seat in each row
+
+public:
+    // Builds a hall from one pattern per row: 'S' is a seat, anything else a gap
+    HallLayout(const string &name, const vector<string> &rowPatterns)
+        : hallName(name), rows(rowPatterns.size()), columns(0)
+    {
+        for (const string &pattern : rowPatterns)
+        {
+            columns = max(columns, (int)pattern.size());
+        }
+        wordsPerRow = (columns + 63) / 64;
+        seatPlane.assign(max<size_t>(1, rows * wordsPerRow), 0);
+        for (int r = 0; r < rows; r++)
+        {
+            rowFirstSeat.push_back(seatPosition.size() + 1);
+            for (int c = 0; c < (int)rowPatterns[r].size(); c++)
+            {
+                if (rowPatterns[r][c] == 'S')
+                {
+                    uint32_t position = r * wordsPerRow * 64 + c;
+                    seatPlane[position >> 6] |= 1ULL << (position & 63);
+                    seatPosition.push_back(position);
+                }
+            }
+        }
+    }
+
+    // A rectangular hall, with an aisle column after every `blockWidth` seats (0 = no aisles)
+    static shared_ptr<HallLayout> grid(const string &name, int rowCount, int seatsPerRow, int blockWidth = 0)
+    {
+        string pattern;
+        for (int seat = 0; seat < seatsPerRow; seat++)
+        {
+            if (blockWidth > 0 && seat > 0 && seat % blockWidth == 0)
+                pattern += '.';
+            pattern += 'S';
+        }
+        return make_shared<HallLayout>(name, vector<string>(rowCount, pattern));
+    }
+
+    const string &name() const { return hallName; }
+    int rowCount() const { return rows; }
+    int columnCount() const { return columns; }
+    size_t rowWords() const { return wordsPerRow; }
+    size_t planeWords() const { return seatPlane.size(); }
+    const uint64_t *plane() const { return seatPlane.data(); }
+    int seatCount() const { return seatPosition.size(); }
+
+    bool validSeat(int seat) const
+    {
+        return seat >= 1 && seat <= seatCount();
+    }
+
+    // Bit position of a seat in the plane; the seat must be valid
+    uint32_t position(int seat) const
+    {
+        return seatPosition[seat - 1];
+    }
+
+    // Seat number at a bit position that holds a seat
+    int seatAt(uint32_t position) const
+    {
+        int row = position / (wordsPerRow * 64);
+        size_t word = position >> 6;
+        int seat = rowFirstSeat[row];
+        for (size_t w = row * wordsPerRow; w < word; w++)
+        {
+            seat += __builtin_popcountll(seatPlane[w]);
+        }
+        return seat + __builtin_popcountll(seatPlane[word] & ((1ULL << (position & 63)) - 1));
+    }
+};
+
+// Bitset view over one show's seats: one bit per position of the hall's plane,
+// set while the seat there is free (gaps are never set). The bits themselves
+// live in the ShowInventory pool.
+class SeatBitmap
+{
+private:
+    uint64_t *words;
+    const HallLayout *layout;
+
+public:
+    SeatBitmap(uint64_t *w, const HallLayout *hall) : words(w), layout(hall) {}
+
+    // Marks every seat free
+    void reset()
+    {
+        copy(layout->plane(), layout->plane() + layout->planeWords(), words);
+    }
+
+    int size() const { return layout->seatCount(); }
+
+    bool validSeat(int seat) const
+    {
+        return layout->validSeat(seat);
+    }
+
+    bool isFree(int seat) const
+    {
+        uint32_t position = layout->position(seat);
+        return (words[position >> 6] >> (position & 63)) & 1ULL;
+    }
+
+    // Marks the seat as taken, returns false if it was already taken
+    bool claim(int seat)
+    {
+        uint32_t position = layout->position(seat);
+        uint64_t mask = 1ULL << (position & 63);
+        uint64_t &word = words[position >> 6];
+        if (!(word & mask))
+            return false;
+        word &= ~mask;
+        return true;
+    }
+
+    void release(int seat)
+    {
+        uint32_t position = layout->position(seat);
+        words[position >> 6] |= 1ULL << (position & 63);
+    }
+
+    int countFree() const
+    {
+        int count = 0;
+        for (size_t w = 0; w < layout->planeWords(); ++w)
+        {
+            count += __builtin_popcountll(words[w]);
+        }
+        return count;
+    }
+
+    // Calls fn(seatNumber) for every free seat, skipping taken ones word by word
+    template <typename Fn>
+    void forEachFree(Fn fn) const
+    {
+        for (size_t w = 0; w < layout->planeWords(); ++w)
+        {
+            uint64_t word = words[w];
+            while (word)
+            {
+                int bit = __builtin_ctzll(word);
+                fn(layout->seatAt(w * 64 + bit));
+                word &= word - 1; // Drop the lowest set bit
+            }
+        }
+    }
+};
+
+// Seat inventory for every show (movie + timing). Each show gets its own seat map,
+// carved out of one contiguous pool and padded to a 64-byte line so two shows
+// never share a cache line.
+class ShowInventory
+{
+private:
+    struct ShowSlot
+    {
+        size_t offset; // First word of this show's seat map in the pool
+        shared_ptr<const HallLayout> hall; // Shared by every show in the same hall
+    };
+
+    static const size_t wordsPerLine = 8;
+
+    vector<uint64_t> pool;
+    vector<ShowSlot> shows;
+
+public:
+    // Allocates a fresh seat map for a show in the given hall and returns its show id
+    int addShow(shared_ptr<const HallLayout> hall)
+    {
+        size_t words = hall->planeWords();
+        words = (words + wordsPerLine - 1) / wordsPerLine * wordsPerLine;
+        ShowSlot slot = {pool.size(), hall};
+        pool.resize(pool.size() + words, 0);
+        shows.push_back(slot);
+        seats(shows.size() - 1).reset();
+        return shows.size() - 1;
+    }
+
+    // Makes room for more shows in one allocation
+    void reserve(size_t showCount, size_t seatWords)
+    {
+        shows.reserve(shows.size() + showCount);
+        pool.reserve(pool.size() + seatWords + showCount * wordsPerLine);
+    }
+
+    int showCount() const
+    {
+        return shows.size();
+    }
+
+    SeatBitmap seats(int showId)
+    {
+        const ShowSlot &slot = shows[showId];
+        return SeatBitmap(&pool[slot.offset], slot.hall.get());
+    }
+
+    int freeSeatCount(int showId)
+    {
+        return seats(showId).countFree();
+    }
+
+    void displayAvailableSeats(int showId, const string &timing, OutputBuffer &out = screen)
+    {
+        out << "Available seats for timing " << timing << ": ";
+        seats(showId).forEachFree([&out](int seat)
+                                  { out << seat << ' '; });
+        out << '\n';
+    }
+
+    bool bookSeats(int showId, const vector<int> &seatNumbers)
+    {
+        SeatBitmap map = seats(showId);
+        for (size_t i = 0; i < seatNumbers.size(); ++i)
+        {
+            int seat = seatNumbers[i];
+            if (!map.validSeat(seat) || !map.claim(seat))
+            {
+                // Roll back the seats claimed so far (also rejects duplicates)
+                for (size_t j = 0; j < i; ++j)
+                {
+                    map.release(seatNumbers[j]);
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool cancelSeats(int showId, const vector<int> &seatNumbers)
+    {
+        SeatBitmap map = seats(showId);
+        for (int seat : seatNumbers)
+        {
+            if (!map.validSeat(seat))
+            {
+                return false;
+            }
+        }
+        for (int seat : seatNumbers)
+        {
+            map.release(seat);
+        }
+        return true;
+    }
+};
+
+// Hierarchical timing wheel: four levels of 64 slots, each level 64 times coarser
+// than the one below. A timer sits in the coarsest slot that still separates it
+// from "now" and drops a level each time that slot comes round, so scheduling,
+// cancelling and each tick are O(1) no matter how many timers are pending.
+// Timers are identified by small non-negative ids chosen by the caller.
+class TimingWheel
+{
+private:
+    static const int levels = 4;
+    static const int slotBits = 6;
+    static const int slots = 1 << slotBits;
+    static const uint64_t maxDelay = (1ULL << (levels * slotBits)) - 1;
+
+    uint64_t current = 0;         // Last tick processed
+    vector<int> heads;            // First timer in each bucket, -1 if empty
+    vector<int> next, prev;       // Intrusive doubly linked bucket lists
+    vector<int> bucketOf;         // Bucket of each timer, -1 if not scheduled
+    vector<uint64_t> expiry;
+    size_t pending = 0;
+
+    void link(int id)
+    {
+        uint64_t delay = expiry[id] - current;
+        int level = 0;
+        while (level < levels - 1 && delay >= (1ULL << ((level + 1) * slotBits)))
+        {
+            level++;
+        }
+        int bucket = level * slots + ((expiry[id] >> (level * slotBits)) & (slots - 1));
+        bucketOf[id] = bucket;
+        prev[id] = -1;
+        next[id] = heads[bucket];
+        if (heads[bucket] >= 0)
+            prev[heads[bucket]] = id;
+        heads[bucket] = id;
+    }
+
+    void unlink(int id)
+    {
+        int bucket = bucketOf[id];
+        if (prev[id] >= 0)
+            next[prev[id]] = next[id];
+        else
+            heads[bucket] = next[id];
+        if (next[id] >= 0)
+            prev[next[id]] = prev[id];
+        bucketOf[id] = -1;
+    }
+
+public:
+    TimingWheel() : heads(levels * slots, -1) {}
+
+    uint64_t now() const { return current; }
+
+    bool scheduled(int id) const
+    {
+        return id < (int)bucketOf.size() && bucketOf[id] >= 0;
+    }
+
+    // Fires `id` at tick `when` (or on the next tick if that has already passed)
+    void schedule(int id, uint64_t when)
+    {
+        if (id >= (int)bucketOf.size())
+        {
+            next.resize(id + 1);
+            prev.resize(id + 1);
+            bucketOf.resize(id + 1, -1);
+            expiry.resize(id + 1);
+        }
+        if (scheduled(id))
+            cancel(id);
+        expiry[id] = min(max(when, current + 1), current + maxDelay);
+        link(id);
+        pending++;
+    }
+
+    void cancel(int id)
+    {
+        if (!scheduled(id))
+            return;
+        unlink(id);
+        pending--;
+    }
+
+    // Runs every tick up to `until`, calling onExpire(id) for each timer that fires
+    template <typename Fn>
+    void advance(uint64_t until, Fn onExpire)
+    {
+        if (pending == 0 && until > current)
+        {
+            current = until; // Nothing to fire, skip the idle ticks
+            return;
+        }
+        while (current < until)
+        {
+            current++;
+            // When a level wraps, pull the matching slot of the next level down
+            for (int level = 1; level < levels; level++)
+            {
+                if ((current & ((1ULL << (level * slotBits)) - 1)) != 0)
+                    break;
+                int bucket = level * slots + ((current >> (level * slotBits)) & (slots - 1));
+                int id = heads[bucket];
+                heads[bucket] = -1;
+                while (id >= 0)
+                {
+                    int following = next[id];
+                    link(id);
+                    id = following;
+                }
+            }
+            int bucket = current & (slots - 1);
+            while (heads[bucket] >= 0)
+            {
+                int id = heads[bucket];
+                unlink(id);
+                pending--;
+                onExpire(id);
+            }
+            if (pending == 0)
+            {
+                current = max(current, until);
+                return;
+            }
+        }
+    }
+};
+
+// Seats set aside for a customer while they pay. A hold takes the seats out of the
+// show's seat map straight away and puts them back if it is not confirmed before
+// it expires. Handles carry a generation so a stale handle is never confused with
+// a newer hold that reused the same slot.
+class SeatHoldTable
+{
+private:
+    struct SeatHold
+    {
+        int showId;
+        vector<int> seatNumbers;
+        uint32_t generation = 0;
+        bool active = false;
+    };
+
+    ShowInventory &inventory;
+    vector<SeatHold> holds;
+    vector<int> freeSlots;
+    TimingWheel wheel;
+    size_t expiredCount = 0;
+
+    int slotOf(uint64_t handle) const
+    {
+        int slot = handle & 0xffffffffu;
+        if (slot >= (int)holds.size() || !holds[slot].active || holds[slot].generation != handle >> 32)
+            return -1;
+        return slot;
+    }
+
+    void freeSlot(int slot)
+    {
+        holds[slot].active = false;
+        holds[slot].generation++;
+        holds[slot].seatNumbers.clear();
+        freeSlots.push_back(slot);
+    }
+
+public:
+    static const uint64_t noHold = ~0ULL;
+
+    SeatHoldTable(ShowInventory &inv) : inventory(inv) {}
+
+    // Holds the seats until tick `expiresAt`; returns noHold if any seat is taken
+    uint64_t place(int showId, const vector<int> &seatNumbers, uint64_t expiresAt)
+    {
+        if (!inventory.bookSeats(showId, seatNumbers))
+            return noHold;
+        int slot;
+        if (!freeSlots.empty())
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            slot = holds.size();
+            holds.push_back(SeatHold());
+        }
+        SeatHold &hold = holds[slot];
+        hold.showId = showId;
+        hold.seatNumbers = seatNumbers;
+        hold.active = true;
+        wheel.schedule(slot, expiresAt);
+        return (uint64_t(hold.generation) << 32) | slot;
+    }
+
+    // Turns the hold into a booking; false if it already expired
+    bool confirm(uint64_t handle)
+    {
+        int slot = slotOf(handle);
+        if (slot < 0)
+            return false;
+        wheel.cancel(slot);
+        freeSlot(slot); // The seats stay taken
+        return true;
+    }
+
+    // Gives the seats back before the hold expires
+    void release(uint64_t handle)
+    {
+        int slot = slotOf(handle);
+        if (slot < 0)
+            return;
+        wheel.cancel(slot);
+        inventory.cancelSeats(holds[slot].showId, holds[slot].seatNumbers);
+        freeSlot(slot);
+    }
+
+    // Releases every hold whose expiry tick is at or before `now`
+    void expire(uint64_t now)
+    {
+        wheel.advance(now, [this](int slot)
+                      {
+            inventory.cancelSeats(holds[slot].showId, holds[slot].seatNumbers);
+            freeSlot(slot);
+            expiredCount++; });
+    }
+
+    size_t expired() const { return expiredCount; }
+};
+
+// Append-only record of the money taken: every card authorisation, capture,
+// void and refund is one entry, amounts in whole cents. Entries are stored column by
+// column, so a settlement run streams through just the fields it sums.
+class PaymentLedger
+{
+public:
+    enum Kind : uint8_t
+    {
+        Authorised, // The gateway approved the charge
+        Captured,   // The money was taken and a ticket issued
+        Voided,     // An approved charge that is being given back
+        Refunded,   // Captured money given back for cancelled seats
+        kindCount
+    };
+
+    enum Method : uint8_t
+    {
+        Cash,
+        Card,
+        methodCount
+    };
+
+    // Totals for one show and payment method
+    struct Totals
+    {
+        int showId;
+        Method method;
+        long long cents[kindCount];
+        uint32_t count[kindCount];
+    };
+
+    // One settlement run: everything recorded since the run before
+    struct Settlement
+    {
+        size_t firstEntry, endEntry;     // Entries [firstEntry, endEntry)
+        vector<Totals> shows;            // Only shows with entries, by show id then method
+        long long cents[methodCount][kindCount] = {};
+        uint32_t count[methodCount][kindCount] = {};
+
+        // Money kept: captured less voided and refunded
+        long long netCents() const
+        {
+            long long net = 0;
+            for (int method = 0; method < methodCount; method++)
+                net += cents[method][Captured] - cents[method][Voided] - cents[method][Refunded];
+            return net;
+        }
+    };
+
+private:
+    vector<int32_t> showColumn;
+    vector<uint8_t> kindColumn, methodColumn;
+    vector<int64_t> centsColumn;
+    vector<uint64_t> referenceColumn; // Gateway reference, 0 for cash
+    vector<Settlement> runs;
+    size_t settledUpTo = 0;
+
+public:
+    void record(Kind kind, Method method, int showId, long long cents, uint64_t reference)
+    {
+        showColumn.push_back(showId);
+        kindColumn.push_back(kind);
+        methodColumn.push_back(method);
+        centsColumn.push_back(cents);
+        referenceColumn.push_back(reference);
+    }
+
+    void reserve(size_t entries)
+    {
+        showColumn.reserve(entries);
+        kindColumn.reserve(entries);
+        methodColumn.reserve(entries);
+        centsColumn.reserve(entries);
+        referenceColumn.reserve(entries);
+    }
+
+    size_t size() const { return showColumn.size(); }
+    size_t unsettled() const { return size() - settledUpTo; }
+    uint64_t reference(size_t entry) const { return referenceColumn[entry]; }
+
+    // Settles every entry recorded since the last run in one pass: each entry
+    // adds to a dense (show, method, kind) table, whose used rows are then
+    // listed in show order
+    const Settlement &settle()
+    {
+        Settlement run;
+        run.firstEntry = settledUpTo;
+        run.endEntry = size();
+        int showLimit = 0;
+        for (size_t i = run.firstEntry; i < run.endEntry; i++)
+            showLimit = max(showLimit, showColumn[i] + 1);
+
+        const size_t cells = size_t(showLimit) * methodCount * kindCount;
+        vector<long long> sums(cells);
+        vector<uint32_t> counts(cells);
+        const int32_t *show = showColumn.data();
+        const uint8_t *kind = kindColumn.data(), *method = methodColumn.data();
+        const int64_t *cents = centsColumn.data();
+        for (size_t i = run.firstEntry; i < run.endEntry; i++)
+        {
+            size_t cell = (size_t(show[i]) * methodCount + method[i]) * kindCount + kind[i];
+            sums[cell] += cents[i];
+            counts[cell]++;
+        }
+
+        for (int showId = 0; showId < showLimit; showId++)
+        {
+            for (int m = 0; m < methodCount; m++)
+            {
+                size_t base = (size_t(showId) * methodCount + m) * kindCount;
+                Totals totals = {showId, Method(m), {}, {}};
+                bool used = false;
+                for (int k = 0; k < kindCount; k++)
+                {
+                    totals.cents[k] = sums[base + k];
+                    totals.count[k] = counts[base + k];
+                    run.cents[m][k] += sums[base + k];
+                    run.count[m][k] += counts[base + k];
+                    used |= counts[base + k] != 0;
+                }
+                if (used)
+                    run.shows.push_back(totals);
+            }
+        }
+        settledUpTo = run.endEntry;
+        runs.push_back(move(run));
+        return runs.back();
+    }
+
+    const vector<Settlement> &settlements() const { return runs; }
+};
+
+// Class for a Ticket
+class Ticket
+{
+public:
+    Symbol customerName;
+    PhoneKey mobileNumber;
+    Symbol movieTitle;
+    Symbol movieTiming;
+    vector<int> seatNumbers;
+    double totalPrice;
+    PaymentLedger::Method paymentMethod = PaymentLedger::Cash; // How it was paid, for refunds
+    uint64_t paymentReference = 0;                              // Gateway reference of the charge, 0 for cash
+
+    Ticket(const string &name, PhoneKey mobile, const string &title, const string &timing, vector<int> seats, double price)
+        : customerName(symbols.intern(name)), mobileNumber(mobile),
+          movieTitle(symbols.intern(title)), movieTiming(symbols.intern(timing)),
+          seatNumbers(seats), totalPrice(price) {}
+
+    Ticket(Symbol name, PhoneKey mobile, Symbol title, Symbol timing, vector<int> seats, double price)
+        : customerName(name), mobileNumber(mobile), movieTitle(title), movieTiming(timing),
+          seatNumbers(seats), totalPrice(price) {}
+
+    void displayTicket(OutputBuffer &out = screen) const
+    {
+        out << "\n--- Ticket Details ---\n"
+            << "Customer Name: " << symbols.str(customerName) << '\n'
+            << "Mobile Number: " << mobileNumber << '\n'
+            << "Movie Title: " << symbols.str(movieTitle) << '\n'
+            << "Movie Timing: " << symbols.str(movieTiming) << '\n'
+            << "Seat Numbers: ";
+        for (int seat : seatNumbers)
+        {
+            out << seat << ' ';
+        }
+        out << "\nTotal Price: $";
+        out.money(totalPrice) << '\n';
+    }
+};
+
+// How a customer pays. A payment only describes the charge; it is sent to a
+// PaymentProvider, so building one never waits on the customer or the bank.
+class Payment
+{
+protected:
+    double amount;
+
+public:
+    Payment(double amt) : amount(amt) {}
+    virtual ~Payment() {}
+
+    double total() const { return amount; }
+    long long cents() const { return llround(amount * 100); }
+
+    virtual PaymentLedger::Method method() const = 0;
+
+    // Cash is taken at the counter; everything else goes through the gateway
+    virtual bool needsGateway() const = 0;
+
+    // False if the details can never be approved, such as a malformed PIN
+    virtual bool detailsValid() const { return true; }
+
+    virtual void printReceipt(OutputBuffer &out) const = 0;
+};
+
+class CashPayment : public Payment
+{
+public:
+    CashPayment(double amt) : Payment(amt) {}
+
+    PaymentLedger::Method method() const override { return PaymentLedger::Cash; }
+
+    bool needsGateway() const override { return false; }
+
+    void printReceipt(OutputBuffer &out) const override
+    {
+        out << "Payment of $";
+        out.money(amount) << " received in cash.\n";
+    }
+};
+
+class CreditCardPayment : public Payment
+{
+private:
+    string pin;
+
+public:
+    CreditCardPayment(double amt, const string &cardPin) : Payment(amt), pin(cardPin) {}
+
+    PaymentLedger::Method method() const override { return PaymentLedger::Card; }
+
+    bool needsGateway() const override { return true; }
+
+    bool detailsValid() const override { return validatePin(pin); }
+
+    void printReceipt(OutputBuffer &out) const override
+    {
+        out << "Payment of $";
+        out.money(amount) << " processed successfully via credit card.\n";
+    }
+
+    // Helper function to validate 4-digit PIN
+    static bool validatePin(const string &pin)
+    {
+        return pin.length() == 4 && all_of(pin.begin(), pin.end(), ::isdigit);
+    }
+};
+
+// Gateway's answer to one charge
+struct PaymentResult
+{
+    bool approved = false;
+    uint64_t reference = 0; // Gateway's id for the charge, 0 if it never got there
+    string reason;          // Why it was declined
+};
+
+// Anything that can charge a payment. charge() returns straight away; the
+// future becomes ready when the charge is approved or declined, so any number
+// of payments can be in flight while bookings carry on.
+class PaymentProvider
+{
+public:
+    virtual ~PaymentProvider() {}
+    virtual future<PaymentResult> charge(const Payment &payment) = 0;
+};
+
+// Stand-in for a card gateway: every charge is answered after the configured
+// latency (plus up to the same again of random jitter) and declined at the
+// configured rate. One timer thread answers all charges in due order, however
+// many are in flight; it is started by the first charge.
+class SimulatedGateway : public PaymentProvider
+{
+private:
+    struct Charge
+    {
+        chrono::steady_clock::time_point due;
+        promise<PaymentResult> done;
+        PaymentResult result;
+    };
+
+    // Earliest due charge at the front of the heap
+    static bool later(const Charge &a, const Charge &b) { return a.due > b.due; }
+
+    chrono::microseconds latency;
+    double failureRate;
+    mutex lock;
+    condition_variable wake;
+    vector<Charge> queue; // Heap ordered by due time
+    thread worker;
+    bool stopping = false;
+    mt19937_64 rng{42};
+    uint64_t nextReference = 1;
+
+    void answerCharges()
+    {
+        unique_lock<mutex> guard(lock);
+        while (true)
+        {
+            if (queue.empty())
+            {
+                if (stopping)
+                    return;
+                wake.wait(guard);
+                continue;
+            }
+            chrono::steady_clock::time_point due = queue.front().due; // A copy: the queue may grow while we sleep
+            if (!stopping && due > chrono::steady_clock::now())
+            {
+                wake.wait_until(guard, due);
+                continue;
+            }
+            pop_heap(queue.begin(), queue.end(), later);
+            Charge charge = move(queue.back());
+            queue.pop_back();
+            guard.unlock();
+            if (stopping && charge.result.approved)
+                charge.result = PaymentResult{false, charge.result.reference, "gateway shut down"};
+            charge.done.set_value(move(charge.result));
+            guard.lock();
+        }
+    }
+
+public:
+    SimulatedGateway(chrono::microseconds latency = chrono::milliseconds(300), double failureRate = 0.0)
+        : latency(latency), failureRate(failureRate) {}
+
+    // Declines whatever is still in flight
+    ~SimulatedGateway()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    future<PaymentResult> charge(const Payment &payment) override
+    {
+        Charge charge;
+        future<PaymentResult> answer = charge.done.get_future();
+        {
+            lock_guard<mutex> guard(lock);
+            charge.result.reference = nextReference++;
+            if (!payment.detailsValid())
+                charge.result.reason = "invalid card details";
+            else if (uniform_real_distribution<double>(0, 1)(rng) < failureRate)
+                charge.result.reason = "declined by the bank";
+            else
+                charge.result.approved = true;
+            charge.due = chrono::steady_clock::now() + latency + chrono::microseconds(rng() % (latency.count() + 1));
+            bool first = queue.empty() || later(queue.front(), charge);
+            queue.push_back(move(charge));
+            push_heap(queue.begin(), queue.end(), later);
+            if (!worker.joinable())
+                worker = thread(&SimulatedGateway::answerCharges, this);
+            else if (first)
+                wake.notify_one(); // The timer thread is sleeping until a later charge
+        }
+        return answer;
+    }
+};
+
+// Open-addressing index from a (title, timing) symbol pair to a movie's
+// position in the movies vector
+class ShowIndex
+{
+private:
+    struct Slot
+    {
+        uint64_t key;
+        int position; // -1 = empty
+    };
+
+    vector<Slot> slots; // Size is a power of two, at most half full
+    size_t used = 0;
+
+    static uint64_t keyOf(Symbol title, Symbol timing)
+    {
+        return (uint64_t(title) << 32) | timing;
+    }
+
+    size_t probe(uint64_t key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = mixHash(key) & mask;
+        while (slots[i].position >= 0 && slots[i].key != key)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        vector<Slot> old = slots;
+        slots.assign(max<size_t>(16, old.size() * 2), Slot{0, -1});
+        for (const Slot &slot : old)
+        {
+            if (slot.position >= 0)
+                slots[probe(slot.key)] = slot;
+        }
+    }
+
+public:
+    // Adds a show; the first movie added for a title and timing wins
+    void insert(Symbol title, Symbol timing, int position)
+    {
+        if ((used + 1) * 2 > slots.size())
+            grow();
+        uint64_t key = keyOf(title, timing);
+        size_t i = probe(key);
+        if (slots[i].position < 0)
+        {
+            slots[i] = Slot{key, position};
+            used++;
+        }
+    }
+
+    // Position of the movie, or -1 if there is no such show
+    int find(Symbol title, Symbol timing) const
+    {
+        if (title == SymbolTable::none || timing == SymbolTable::none || slots.empty())
+            return -1;
+        return slots[probe(keyOf(title, timing))].position;
+    }
+
+    // Sizes the table for this many shows, so bulk inserts never rehash
+    void reserve(size_t shows)
+    {
+        size_t size = max<size_t>(16, slots.size());
+        while (size < 2 * shows)
+            size *= 2;
+        if (size > slots.size())
+        {
+            vector<Slot> old;
+            old.swap(slots);
+            slots.assign(size, Slot{0, -1});
+            for (const Slot &slot : old)
+            {
+                if (slot.position >= 0)
+                    slots[probe(slot.key)] = slot;
+            }
+        }
+    }
+};
+
+// Secondary index from a customer's mobile number, as a PhoneKey, to the
+// positions of their tickets. Open addressing on the packed key; each customer
+// has only a few tickets, so lookup, insert and remove are O(1) amortised.
+class CustomerTicketIndex
+{
+private:
+    struct Slot
+    {
+        uint64_t key;
+        int list; // Index into lists, -1 = empty slot
+    };
+
+    vector<Slot> slots; // Size is a power of two, at most half full
+    vector<vector<int>> lists;
+
+    size_t probe(uint64_t key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = mixHash(key) & mask;
+        while (slots[i].list >= 0 && slots[i].key != key)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        vector<Slot> old = slots;
+        slots.assign(max<size_t>(16, old.size() * 2), Slot{0, -1});
+        for (const Slot &slot : old)
+        {
+            if (slot.list >= 0)
+                slots[probe(slot.key)] = slot;
+        }
+    }
+
+    vector<int> *listFor(uint64_t key)
+    {
+        if (slots.empty())
+            return nullptr;
+        size_t i = probe(key);
+        return slots[i].list >= 0 ? &lists[slots[i].list] : nullptr;
+    }
+
+public:
+    void insert(PhoneKey mobile, int ticket)
+    {
+        uint64_t key = mobile.packed();
+        if ((lists.size() + 1) * 2 > slots.size())
+            grow();
+        size_t i = probe(key);
+        if (slots[i].list < 0)
+        {
+            slots[i] = Slot{key, (int)lists.size()};
+            lists.emplace_back();
+        }
+        lists[slots[i].list].push_back(ticket);
+    }
+
+    void remove(PhoneKey mobile, int ticket)
+    {
+        vector<int> *list = listFor(mobile.packed());
+        if (!list)
+            return;
+        auto it = std::find(list->begin(), list->end(), ticket);
+        if (it != list->end())
+        {
+            *it = list->back();
+            list->pop_back();
+        }
+    }
+
+    // Records that a ticket moved from one position to another
+    void move(PhoneKey mobile, int from, int to)
+    {
+        vector<int> *list = listFor(mobile.packed());
+        if (!list)
+            return;
+        auto it = std::find(list->begin(), list->end(), from);
+        if (it != list->end())
+            *it = to;
+    }
+
+    // Positions of every ticket booked with this mobile number
+    const vector<int> &find(PhoneKey mobile) const
+    {
+        static const vector<int> none;
+        if (slots.empty())
+            return none;
+        size_t i = probe(mobile.packed());
+        return slots[i].list >= 0 ? lists[slots[i].list] : none;
+    }
+};
+
+// Class for managing the entire booking system
+class BookingSystem
+{
+private:
+    vector<Movie> movies; // Show id == index in movies
+    ShowIndex showIndex;  // (title, timing) -> show id
+    ScheduleIndex schedule; // Show ids by start time
+    ShowInventory inventory;
+    SeatHoldTable holds{inventory};
+    vector<Ticket> bookedTickets;
+    CustomerTicketIndex ticketIndex; // Mobile number -> positions in bookedTickets
+
+    static const int holdSeconds = 120; // How long seats stay held while the customer pays
+
+    // A booking whose seats are held while its payment is charged
+    struct PendingBooking
+    {
+        uint64_t hold;
+        Symbol customerName;
+        PhoneKey mobileNumber;
+        int showId;
+        vector<int> seatNumbers;
+        unique_ptr<Payment> payment;
+        future<PaymentResult> result;
+        bool active = false;
+    };
+
+    unique_ptr<PaymentProvider> gateway = make_unique<SimulatedGateway>();
+    vector<PendingBooking> pending;
+    vector<int> freePending;
+    CustomerTicketIndex pendingIndex; // Mobile number -> slots in pending
+    size_t paymentsInFlight = 0;
+    PaymentLedger ledger;
+    chrono::steady_clock::time_point lastSettlement = chrono::steady_clock::now();
+
+    static constexpr int settlementMinutes = 60; // A settlement run at least this often while payments come in
+
+    // Issues the ticket if the payment went through and the hold is still live,
+    // otherwise gives the seats back
+    void completeBooking(int slot, PaymentResult result, OutputBuffer &out)
+    {
+        PendingBooking &booking = pending[slot];
+        const Movie &movie = movies[booking.showId];
+        const Payment &payment = *booking.payment;
+        if (result.approved && payment.needsGateway())
+            ledger.record(PaymentLedger::Authorised, payment.method(), booking.showId, payment.cents(), result.reference);
+        if (result.approved && holds.confirm(booking.hold))
+        {
+            ledger.record(PaymentLedger::Captured, payment.method(), booking.showId, payment.cents(), result.reference);
+            Ticket ticket(booking.customerName, booking.mobileNumber, movie.title, movie.timing, booking.seatNumbers,
+                          booking.payment->total());
+            ticket.paymentMethod = payment.method();
+            ticket.paymentReference = result.reference;
+            bookedTickets.push_back(ticket);
+            ticketIndex.insert(booking.mobileNumber, bookedTickets.size() - 1);
+            booking.payment->printReceipt(out);
+            out << "Ticket(s) booked successfully!\n";
+            ticket.displayTicket(out);
+        }
+        else
+        {
+            holds.release(booking.hold);
+            if (result.approved)
+                ledger.record(PaymentLedger::Voided, payment.method(), booking.showId, payment.cents(), result.reference);
+            out << "Booking for " << symbols.str(booking.customerName) << " (" << symbols.str(movie.title) << ", "
+                << symbols.str(movie.timing) << ") failed: ";
+            if (result.approved)
+                out << "the seat hold expired before the payment cleared; the payment will be refunded.\n";
+            else
+                out << "payment " << (long long)result.reference << ' ' << result.reason << ".\n";
+        }
+        pendingIndex.remove(booking.mobileNumber, slot);
+        booking.active = false;
+        booking.payment.reset();
+        booking.seatNumbers.clear();
+        freePending.push_back(slot);
+        paymentsInFlight--;
+    }
+
+    // Hold timers tick every 100 ms of steady-clock time
+    static uint64_t currentTick()
+    {
+        return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count() / 100;
+    }
+
+    shared_ptr<const HallLayout> mainHall = HallLayout::grid("Main Hall", 5, 10); // 50 seats
+
+    // Returns the show id for a movie and timing, or -1 if there is no such show
+    int findShow(const string &movieTitle, const string &timing) const
+    {
+        return showIndex.find(symbols.find(movieTitle), symbols.find(timing));
+    }
+
+public:
+    // Add a movie to the system, with its own seat map in the given hall
+    void addMovie(const Movie &movie, shared_ptr<const HallLayout> hall)
+    {
+        movies.push_back(movie);
+        inventory.addShow(hall);
+        showIndex.insert(movie.title, movie.timing, movies.size() - 1);
+        schedule.insert(movie.startMinute, movies.size() - 1);
+    }
+
+    // Add a movie playing in the main hall
+    void addMovie(const Movie &movie)
+    {
+        addMovie(movie, mainHall);
+    }
+
+    // Adds many shows at once, movie i playing in halls[hallOf[i]], with every
+    // table sized once up front. A show whose title and timing are already
+    // listed is skipped; returns how many were added.
+    size_t addMovies(const vector<Movie> &batch, const vector<int> &hallOf, const vector<shared_ptr<const HallLayout>> &halls)
+    {
+        size_t seatWords = 0;
+        for (int hall : hallOf)
+            seatWords += halls[hall]->planeWords();
+        movies.reserve(movies.size() + batch.size());
+        inventory.reserve(batch.size(), seatWords);
+        showIndex.reserve(movies.size() + batch.size());
+        size_t added = 0;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            if (showIndex.find(batch[i].title, batch[i].timing) >= 0)
+                continue;
+            addMovie(batch[i], halls[hallOf[i]]);
+            added++;
+        }
+        return added;
+    }
+
+    int showCount() const { return movies.size(); }
+
+    shared_ptr<const HallLayout> defaultHall() const { return mainHall; }
+
+    // Show movies sorted by timing
+    void showMoviesToday() const
+    {
+        screen << "\nMovies Today (Sorted by Timing):\n";
+        schedule.forEach([this](int showId)
+                         { movies[showId].displayMovieDetails(); });
+        screen.flush();
+    }
+
+    // Check currently available seats for a movie and timing
+    bool checkAvailableSeats(const string &movieTitle, const string &timing)
+    {
+        holds.expire(currentTick());
+        int showId = findShow(movieTitle, timing);
+        if (showId < 0)
+        {
+            cout << "Movie not found or invalid timing.\nPlease check movie details.\n";
+            return false;
+        }
+        inventory.displayAvailableSeats(showId, timing);
+        screen.flush();
+        return true;
+    }
+
+    // Charges card payments through this provider from now on
+    void setPaymentProvider(unique_ptr<PaymentProvider> provider)
+    {
+        gateway = move(provider);
+    }
+
+    // Holds the seats and starts charging for them without waiting for the
+    // answer; the ticket is issued by settlePayments once the payment clears.
+    // pay(total) builds the payment, or returns null if the customer backs out.
+    // Returns false if no payment was started.
+    bool placeBooking(const string &customerName, const string &mobileNumber, const string &movieTitle, const string &timing,
+                      const vector<int> &seatNumbers, const function<unique_ptr<Payment>(double)> &pay, OutputBuffer &out = screen)
+    {
+        if (customerName == "" || mobileNumber == "" || movieTitle == "" || timing == "" || seatNumbers.size() == 0)
+        {
+            out << "Please enter all the details\n";
+            return false;
+        }
+        int showId = findShow(movieTitle, timing);
+        if (showId < 0)
+        {
+            out << "Movie not found or invalid timing.\nPlease check movie details.\n";
+            return false;
+        }
+
+        bool alreadyBooked = false;
+        PhoneKey phone(mobileNumber);
+        Symbol nameId = symbols.find(customerName);
+        for (int position : ticketIndex.find(phone))
+        {
+            if (bookedTickets[position].customerName == nameId)
+            {
+                alreadyBooked = true;
+                break;
+            }
+        }
+        for (int slot : pendingIndex.find(phone))
+        {
+            if (pending[slot].customerName == nameId)
+            {
+                alreadyBooked = true;
+                break;
+            }
+        }
+
+        if (alreadyBooked)
+        {
+            out << "You have already booked a ticket\n";
+            return false;
+        }
+
+        double totalPrice = seatNumbers.size() * movies[showId].price; // Calculate total price
+
+        // Hold the seats so nobody else can take them while the customer pays
+        holds.expire(currentTick());
+        uint64_t hold = holds.place(showId, seatNumbers, currentTick() + holdSeconds * 10);
+        if (hold == SeatHoldTable::noHold)
+        {
+            out << "Failed to book ticket(s): Some seats are unavailable.\n";
+            return false;
+        }
+        out << "Seats held for " << holdSeconds / 60 << " minutes while you pay.\n";
+
+        unique_ptr<Payment> payment = pay(totalPrice);
+        if (!payment)
+        {
+            holds.release(hold);
+            out << "Payment not done\n";
+            return false;
+        }
+
+        int slot;
+        if (!freePending.empty())
+        {
+            slot = freePending.back();
+            freePending.pop_back();
+        }
+        else
+        {
+            slot = pending.size();
+            pending.emplace_back();
+        }
+        PendingBooking &booking = pending[slot];
+        booking.hold = hold;
+        booking.customerName = symbols.intern(customerName);
+        booking.mobileNumber = phone;
+        booking.showId = showId;
+        booking.seatNumbers = seatNumbers;
+        if (payment->needsGateway())
+        {
+            booking.result = gateway->charge(*payment);
+            out << "Payment submitted; your ticket is issued as soon as it clears.\n";
+        }
+        else
+        {
+            promise<PaymentResult> paid; // Cash is already in hand
+            paid.set_value(PaymentResult{true, 0, ""});
+            booking.result = paid.get_future();
+        }
+        booking.payment = move(payment);
+        booking.active = true;
+        pendingIndex.insert(phone, slot);
+        paymentsInFlight++;
+        return true;
+    }
+
+    // Completes every booking whose payment has been answered, or with wait
+    // set every booking still in flight. Returns how many were completed.
+    size_t settlePayments(OutputBuffer &out = screen, bool wait = false)
+    {
+        if (paymentsInFlight == 0)
+            return 0;
+        holds.expire(currentTick());
+        size_t completed = 0;
+        for (size_t slot = 0; slot < pending.size(); slot++)
+        {
+            PendingBooking &booking = pending[slot];
+            if (!booking.active)
+                continue;
+            if (!wait && booking.result.wait_for(chrono::seconds(0)) != future_status::ready)
+                continue;
+            completeBooking(slot, booking.result.get(), out);
+            completed++;
+        }
+        if (chrono::steady_clock::now() - lastSettlement >= chrono::minutes(settlementMinutes))
+            runSettlement();
+        return completed;
+    }
+
+    // Settles the ledger entries recorded since the last run
+    const PaymentLedger::Settlement &runSettlement()
+    {
+        lastSettlement = chrono::steady_clock::now();
+        return ledger.settle();
+    }
+
+    const PaymentLedger &paymentLedger() const { return ledger; }
+
+    // Money on the tickets issued, in cents, to reconcile against the ledger
+    long long ticketRevenueCents() const
+    {
+        long long cents = 0;
+        for (const Ticket &ticket : bookedTickets)
+            cents += llround(ticket.totalPrice * 100);
+        return cents;
+    }
+
+    void printSettlement(const PaymentLedger::Settlement &run, OutputBuffer &out = screen) const
+    {
+        static const char *methodNames[] = {"Cash", "Card"};
+        out << "\n--- Settlement (ledger entries " << (long long)run.firstEntry << " to " << (long long)run.endEntry << ") ---\n";
+        for (const PaymentLedger::Totals &totals : run.shows)
+        {
+            const Movie &movie = movies[totals.showId];
+            out << symbols.str(movie.title) << ", " << symbols.str(movie.timing) << ", " << methodNames[totals.method]
+                << ": " << (long long)totals.count[PaymentLedger::Captured] << " captured $";
+            out.money(totals.cents[PaymentLedger::Captured] / 100.0);
+            if (totals.count[PaymentLedger::Voided] > 0)
+            {
+                out << ", " << (long long)totals.count[PaymentLedger::Voided] << " voided $";
+                out.money(totals.cents[PaymentLedger::Voided] / 100.0);
+            }
+            if (totals.count[PaymentLedger::Refunded] > 0)
+            {
+                out << ", " << (long long)totals.count[PaymentLedger::Refunded] << " refunded $";
+                out.money(totals.cents[PaymentLedger::Refunded] / 100.0);
+            }
+            out << '\n';
+        }
+        out << "Net taken: $";
+        out.money(run.netCents() / 100.0) << '\n';
+    }
+
+    size_t paymentsPending() const { return paymentsInFlight; }
+
+    size_t ticketCount() const { return bookedTickets.size(); }
+
+    // Book tickets, asking at the console how the customer wants to pay
+    void bookTicket(const string &customerName, const string &mobileNumber, const string &movieTitle, const string &timing, const vector<int> &seatNumbers)
+    {
+        placeBooking(customerName, mobileNumber, movieTitle, timing, seatNumbers, [](double totalPrice) -> unique_ptr<Payment>
+                     {
+            screen.flush();
+            cout << " can youu further pro  ceed to payment ?(Y/N)\n";
+            char ch;
+            cin >> ch;
+            if (ch == 'N' || ch == 'n')
+                return nullptr;
+            int paymentChoice;
+            cout << "Select payment method:\n1. Cash\n2. Credit Card\nChoice: ";
+            cin >> paymentChoice;
+            if (paymentChoice == 1)
+                return make_unique<CashPayment>(totalPrice);
+            if (paymentChoice != 2)
+            {
+                cout << "Invalid payment method selected.\n";
+                return nullptr;
+            }
+            // The PIN is only collected here; the gateway checks it in the background
+            string pin;
+            while (true)
+            {
+                cout << "Enter your 4-digit credit card PIN: ";
+                cin >> pin;
+                if (CreditCardPayment::validatePin(pin))
+                    return make_unique<CreditCardPayment>(totalPrice, pin);
+                cout << "Invalid PIN. Please enter a 4-digit number.\n";
+            } });
+        settlePayments(); // Cash bookings complete straight away
+        screen.flush();
+    }
+
+    // Cancel tickets
+    void cancelTicket(const string &customerName, const string &mobileNumber, const string &movieTitle, const string &timing, const vector<int> &seatNumbers)
+    {
+        bool ticketFound = false;
+        Symbol nameId = symbols.find(customerName), titleId = symbols.find(movieTitle), timingId = symbols.find(timing);
+        for (int position : ticketIndex.find(PhoneKey(mobileNumber)))
+        {
+            auto it = bookedTickets.begin() + position;
+            // Check if the ticket details match for cancellation
+            if (it->customerName == nameId && it->movieTitle == titleId && it->movieTiming == timingId)
+            {
+                bool allSeatsFound = true;
+                for (int seatNumber : seatNumbers)
+                {
+                    if (find(it->seatNumbers.begin(), it->seatNumbers.end(), seatNumber) == it->seatNumbers.end())
+                    {
+                        allSeatsFound = false;
+                        break;
+                    }
+                }
+                if (allSeatsFound)
+                {
+                    int showId = findShow(movieTitle, timing);
+                    if (showId >= 0 && inventory.cancelSeats(showId, seatNumbers))
+                    {
+                        // Update the total price after cancellation
+                        double pricePerSeat = movies[showId].price;
+
+                        // Remove canceled seat numbers from the ticket
+                        for (int seatNumber : seatNumbers)
+                        {
+                            it->seatNumbers.erase(remove(it->seatNumbers.begin(), it->seatNumbers.end(), seatNumber), it->seatNumbers.end());
+                        }
+
+                        // Update totalPrice based on remaining booked seats
+                        long long paidCents = llround(it->totalPrice * 100);
+                        it->totalPrice = it->seatNumbers.size() * pricePerSeat;
+
+                        // Give back the difference through the way it was paid
+                        ledger.record(PaymentLedger::Refunded, it->paymentMethod, showId,
+                                      paidCents - llround(it->totalPrice * 100), it->paymentReference);
+
+                        screen << "Ticket(s) cancelled successfully.\n";
+                        it->displayTicket(); // Display updated ticket information
+                        screen.flush();
+                    }
+                    else
+                    {
+                        cout << "Failed to cancel ticket(s): Some seats were not booked.\n";
+                    }
+                    ticketFound = true;
+                }
+                else
+                {
+                    cout << "Error: Some seats you entered were not booked under your name.\n";
+                }
+                break;
+            }
+        }
+        if (!ticketFound)
+        {
+            cout << "Ticket not found. Please check your details.\n";
+        }
+    }
+
+    void retrieveTicketDetails(const string &customerName, const string &mobileNumber) const
+    {
+        bool ticketFound = false;
+        Symbol nameId = symbols.find(customerName);
+        for (int position : ticketIndex.find(PhoneKey(mobileNumber)))
+        {
+            const Ticket &ticket = bookedTickets[position];
+            if (ticket.customerName == nameId)
+            {
+                ticket.displayTicket();
+                ticketFound = true;
+            }
+        }
+        if (!ticketFound)
+        {
+            screen << "No tickets found for the provided name and mobile number.\n";
+        }
+        screen.flush();
+    }
+
+    // Validate mobile number
+    bool validateMobileNumber(const string &mobileNumber) const
+    {
+        return PhoneKey(mobileNumber).valid();
+    }
+};
+
+// A read-only view of a whole file: mmap where there is one, otherwise read
+// into memory
+class MappedFile
+{
+private:
+    const char *bytes = nullptr;
+    size_t length = 0;
+    vector<char> copy;
+
+public:
+    MappedFile(const string &path)
+    {
+#ifndef _WIN32
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED)
+            {
+                bytes = (const char *)map;
+                length = info.st_size;
+            }
+        }
+        close(fd);
+#else
+        FILE *in = fopen(path.c_str(), "rb");
+        if (!in)
+            return;
+        char buffer[1 << 16];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+            copy.insert(copy.end(), buffer, buffer + n);
+        fclose(in);
+        bytes = copy.data();
+        length = copy.size();
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if (bytes)
+            munmap((void *)bytes, length);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const { return bytes != nullptr; }
+    const char *data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// Bulk import of a schedule CSV with one show per line:
+//
+//   title,genre,duration,date,timing,hall,price
+//   Inception,Sci-Fi,150,2024-06-01,7:00 PM,Grand Hall,12.50
+//
+// The date (YYYY-MM-DD) may be empty; a dated show is listed under the timing
+// "2024-06-01 7:00 PM". Fields may be quoted to hold commas, but not quotes. A
+// first line starting with "title" is taken as a header.
+//
+// The file is mapped and cut into one chunk per core at line boundaries. Each
+// thread parses its chunk into rows of string_views into the mapping, so no
+// field is copied into a std::string. The rows are then interned and added to
+// the BookingSystem in one batch on the calling thread.
+class ScheduleImporter
+{
+public:
+    struct Result
+    {
+        size_t rows = 0, added = 0, duplicates = 0, errorCount = 0;
+        vector<string> errors; // The first few, as "line N: reason"
+    };
+
+private:
+    static const size_t maxErrorsKept = 10;
+    static const int fieldCount = 7;
+
+    struct Row
+    {
+        string_view title, genre, date, timing;
+        int duration, hall, startMinute;
+        double price;
+    };
+
+    struct Chunk
+    {
+        const char *begin, *end;
+        vector<Row> rows;
+        size_t lines = 0;
+        vector<pair<size_t, const char *>> errors; // (line within the chunk, reason)
+    };
+
+    static string_view trim(string_view field)
+    {
+        while (!field.empty() && (field.front() == ' ' || field.front() == '\t'))
+            field.remove_prefix(1);
+        while (!field.empty() && (field.back() == ' ' || field.back() == '\t'))
+            field.remove_suffix(1);
+        return field;
+    }
+
+    // Splits a line into at most fieldCount + 1 fields; -1 on a stray quote
+    static int split(string_view line, string_view *fields)
+    {
+        int count = 0;
+        size_t i = 0;
+        while (count <= fieldCount)
+        {
+            while (i < line.size() && line[i] == ' ')
+                i++;
+            if (i < line.size() && line[i] == '"')
+            {
+                size_t close = line.find('"', i + 1);
+                if (close == string_view::npos)
+                    return -1;
+                fields[count++] = line.substr(i + 1, close - i - 1);
+                i = close + 1;
+                while (i < line.size() && line[i] == ' ')
+                    i++;
+                if (i < line.size() && line[i] != ',')
+                    return -1;
+            }
+            else
+            {
+                size_t comma = line.find(',', i);
+                size_t stop = comma == string_view::npos ? line.size() : comma;
+                if (line.substr(i, stop - i).find('"') != string_view::npos)
+                    return -1;
+                fields[count++] = trim(line.substr(i, stop - i));
+                i = stop;
+            }
+            if (i >= line.size())
+                break;
+            i++; // Past the comma
+        }
+        return count;
+    }
+
+    static bool validDate(string_view date)
+    {
+        if (date.size() != 10 || date[4] != '-' || date[7] != '-')
+            return false;
+        for (int i : {0, 1, 2, 3, 5, 6, 8, 9})
+        {
+            if (!isdigit((unsigned char)date[i]))
+                return false;
+        }
+        return true;
+    }
+
+    static const char *parseRow(string_view line, const vector<shared_ptr<const HallLayout>> &halls, Row &row)
+    {
+        string_view fields[fieldCount + 1];
+        int count = split(line, fields);
+        if (count < 0)
+            return "unbalanced quotes";
+        if (count != fieldCount)
+            return "expected 7 fields";
+        row.title = fields[0];
+        row.genre = fields[1];
+        row.date = fields[3];
+        row.timing = fields[4];
+        if (row.title.empty())
+            return "missing title";
+        if (row.title.size() > 0xFFFF)
+            return "title too long";
+        auto duration = from_chars(fields[2].data(), fields[2].data() + fields[2].size(), row.duration);
+        if (duration.ec != errc() || duration.ptr != fields[2].data() + fields[2].size() || row.duration <= 0)
+            return "bad duration";
+        if (!row.date.empty() && !validDate(row.date))
+            return "bad date";
+        row.startMinute = parseTiming(row.timing);
+        if (row.startMinute < 0 || row.timing.size() > 16)
+            return "bad timing";
+        row.hall = -1;
+        for (size_t h = 0; h < halls.size(); h++)
+        {
+            if (halls[h]->name() == fields[5])
+                row.hall = h;
+        }
+        if (row.hall < 0)
+            return "unknown hall";
+        auto price = from_chars(fields[6].data(), fields[6].data() + fields[6].size(), row.price);
+        if (price.ec != errc() || price.ptr != fields[6].data() + fields[6].size() || row.price < 0)
+            return "bad price";
+        return nullptr;
+    }
+
+    static void parseChunk(Chunk &chunk, const vector<shared_ptr<const HallLayout>> &halls)
+    {
+        chunk.rows.reserve((chunk.end - chunk.begin) / 48);
+        const char *line = chunk.begin;
+        while (line < chunk.end)
+        {
+            const char *newline = (const char *)memchr(line, '\n', chunk.end - line);
+            const char *stop = newline ? newline : chunk.end;
+            string_view text(line, stop - line);
+            if (!text.empty() && text.back() == '\r')
+                text.remove_suffix(1);
+            chunk.lines++;
+            if (!trim(text).empty())
+            {
+                Row row;
+                if (const char *error = parseRow(text, halls, row))
+                    chunk.errors.push_back({chunk.lines, error});
+                else
+                    chunk.rows.push_back(row);
+            }
+            line = stop + 1;
+        }
+    }
 
-    void displayMovieDetails() const
+public:
+    static Result importFile(const string &path, BookingSystem &system, const vector<shared_ptr<const HallLayout>> &halls,
+                             unsigned threadCount = thread::hardware_concurrency())
     {
-        cout << "Title: " << title << ", Genre: " << genre
-             << ", Duration: " << duration << " min, Timing: "
-             << timing << ", Price: $" << fixed << setprecision(2) << price << endl;
+        Result result;
+        MappedFile file(path);
+        if (!file.isOpen())
+        {
+            result.errorCount = 1;
+            result.errors.push_back("cannot read " + path);
+            return result;
+        }
+        const char *begin = file.data(), *end = file.data() + file.size();
+
+        // Skip a header line
+        size_t headerLines = 0;
+        string_view first(begin, min<size_t>(5, end - begin));
+        if (first.size() == 5 && equal(first.begin(), first.end(), "title", [](char a, char b)
+                                       { return tolower((unsigned char)a) == b; }))
+        {
+            const char *newline = (const char *)memchr(begin, '\n', end - begin);
+            begin = newline ? newline + 1 : end;
+            headerLines = 1;
+        }
+
+        // One chunk per thread, cut after a newline; small files get one thread
+        threadCount = max(1u, min<unsigned>(threadCount, (end - begin) / (1 << 16) + 1));
+        vector<Chunk> chunks(threadCount);
+        const char *cut = begin;
+        for (unsigned t = 0; t < threadCount; t++)
+        {
+            chunks[t].begin = cut;
+            const char *target = t + 1 == threadCount ? end : max(cut, begin + (end - begin) * (t + 1) / threadCount);
+            const char *newline = target < end ? (const char *)memchr(target, '\n', end - target) : nullptr;
+            cut = newline ? newline + 1 : end;
+            chunks[t].end = cut;
+        }
+        vector<thread> workers;
+        for (unsigned t = 1; t < threadCount; t++)
+            workers.emplace_back(parseChunk, ref(chunks[t]), cref(halls));
+        parseChunk(chunks[0], halls);
+        for (thread &worker : workers)
+            worker.join();
+
+        // Intern and add everything in file order
+        size_t rowCount = 0, lineOffset = headerLines;
+        for (const Chunk &chunk : chunks)
+        {
+            rowCount += chunk.rows.size();
+            result.errorCount += chunk.errors.size();
+            for (const auto &error : chunk.errors)
+            {
+                if (result.errors.size() < maxErrorsKept)
+                    result.errors.push_back("line " + to_string(lineOffset + error.first) + ": " + error.second);
+            }
+            lineOffset += chunk.lines;
+        }
+        vector<Movie> batch;
+        vector<int> hallOf;
+        batch.reserve(rowCount);
+        hallOf.reserve(rowCount);
+        char timingKey[32]; // "YYYY-MM-DD " + timing
+        for (const Chunk &chunk : chunks)
+        {
+            for (const Row &row : chunk.rows)
+            {
+                string_view timing = row.timing;
+                if (!row.date.empty())
+                {
+                    memcpy(timingKey, row.date.data(), 10);
+                    timingKey[10] = ' ';
+                    memcpy(timingKey + 11, row.timing.data(), row.timing.size());
+                    timing = string_view(timingKey, 11 + row.timing.size());
+                }
+                batch.push_back(Movie(symbols.intern(row.title), symbols.intern(row.genre), row.duration,
+                                      symbols.intern(timing), row.startMinute, row.price));
+                hallOf.push_back(row.hall);
+            }
+        }
+        result.rows = rowCount + result.errorCount;
+        result.added = system.addMovies(batch, hallOf, halls);
+        result.duplicates = rowCount - result.added;
+        return result;
     }
 };
 
-class Theater
+// Seat store benchmark (run with --bench)
+// The old vector<int> layout, kept only so the benchmark has a baseline
+class VectorSeatStore
 {
 private:
     vector<int> availableSeats;
 
 public:
-    Theater(int totalSeats)
+    VectorSeatStore(int totalSeats)
     {
         for (int i = 1; i <= totalSeats; ++i)
         {
@@ -42,17 +2168,12 @@ public:
         }
     }
 
-    void displayAvailableSeats(const string &timing)
+    int freeSeatCount() const
     {
-        cout << "Available seats for timing " << timing << ": ";
-        for (int seat : availableSeats)
-        {
-            cout << seat << " ";
-        }
-        cout << endl;
+        return availableSeats.size();
     }
 
-    bool bookSeats(const string &timing, const vector<int> &seatNumbers)
+    bool bookSeats(const string &, const vector<int> &seatNumbers)
     {
         for (int seat : seatNumbers)
         {
@@ -61,7 +2182,6 @@ public:
                 return false;
             }
         }
-
         for (int seat : seatNumbers)
         {
             availableSeats.erase(remove(availableSeats.begin(), availableSeats.end(), seat), availableSeats.end());
@@ -69,7 +2189,7 @@ public:
         return true;
     }
 
-    bool cancelSeats(const string &timing, const vector<int> &seatNumbers)
+    bool cancelSeats(const string &, const vector<int> &seatNumbers)
     {
         for (int seat : seatNumbers)
         {
@@ -79,327 +2199,446 @@ public:
     }
 };
 
-// Class for a Ticket
-class Ticket
+// One show in a ShowInventory, with the same interface as VectorSeatStore
+class PooledSeatStore
 {
+private:
+    ShowInventory inventory;
+    int showId;
+
 public:
-    string customerName;
-    string mobileNumber;
-    string movieTitle;
-    string movieTiming;
-    vector<int> seatNumbers;
-    double totalPrice;
+    // Rows of up to 50 seats
+    PooledSeatStore(int totalSeats)
+        : showId(inventory.addShow(HallLayout::grid("Benchmark", max(1, totalSeats / 50), min(50, totalSeats)))) {}
 
-    Ticket(string name, string mobile, string title, string timing, vector<int> seats, double price)
-        : customerName(name), mobileNumber(mobile), movieTitle(title), movieTiming(timing),
-          seatNumbers(seats), totalPrice(price) {}
+    int freeSeatCount() { return inventory.freeSeatCount(showId); }
 
-    void displayTicket() const
+    bool bookSeats(const string &, const vector<int> &seatNumbers)
     {
-        cout << "\n--- Ticket Details ---\n";
-        cout << "Customer Name: " << customerName << "\n"
-             << "Mobile Number: " << mobileNumber << "\n"
-             << "Movie Title: " << movieTitle << "\n"
-             << "Movie Timing: " << movieTiming << "\n"
-             << "Seat Numbers: ";
-        for (int seat : seatNumbers)
-        {
-            cout << seat << " ";
-        }
-        cout << "\nTotal Price: $" << fixed << setprecision(2) << totalPrice << endl;
+        return inventory.bookSeats(showId, seatNumbers);
     }
-};
-
-class Payment
-{
-protected:
-    double amount;
-
-public:
-    Payment(double amt) : amount(amt) {}
-    virtual void processPayment() const = 0; // Pure virtual function
-};
-
-class CashPayment : public Payment
-{
-public:
-    CashPayment(double amt) : Payment(amt) {}
 
-    void processPayment() const override
+    bool cancelSeats(const string &, const vector<int> &seatNumbers)
     {
-        cout << "Payment of $" << fixed << setprecision(2) << amount << " received in cash.\n";
+        return inventory.cancelSeats(showId, seatNumbers);
     }
 };
 
-class CreditCardPayment : public Payment
+// Books and cancels random groups of 4 seats, counting free seats after each booking
+template <typename Store>
+double timeSeatStore(int totalSeats, int rounds)
 {
-public:
-    CreditCardPayment(double amt) : Payment(amt) {}
+    Store store(totalSeats);
+    mt19937 rng(42);
+    uniform_int_distribution<int> pick(1, totalSeats - 3);
+    const string timing = "10:00 AM";
+    long long checksum = 0;
 
-    void processPayment() const override
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
     {
-        string pin;
-        while (true)
+        int first = pick(rng);
+        vector<int> seats = {first, first + 1, first + 2, first + 3};
+        if (store.bookSeats(timing, seats))
         {
-            cout << "Enter your 4-digit credit card PIN: ";
-            cin >> pin;
-            if (validatePin(pin))
-            {
-                cout << "Payment of $" << fixed << setprecision(2) << amount << " processed successfully via credit card.\n";
-                break;
-            }
-            else
-            {
-                cout << "Invalid PIN. Please enter a 4-digit number.\n";
-            }
+            checksum += store.freeSeatCount();
+            store.cancelSeats(timing, seats);
         }
     }
+    auto end = chrono::steady_clock::now();
 
-private:
-    // Helper function to validate 4-digit PIN
-    bool validatePin(const string &pin) const
+    if (checksum < 0)
+        cout << checksum; // Keeps the loop from being optimised away
+    return chrono::duration<double, nano>(end - start).count() / rounds;
+}
+
+void runSeatBenchmark()
+{
+    const int rounds = 20000;
+    cout << "Seat store benchmark (" << rounds << " book+cancel rounds of 4 seats)\n";
+    cout << setw(8) << "Seats" << setw(16) << "vector ns/op" << setw(16) << "bitmap ns/op" << endl;
+    for (int seats : {50, 500, 50000})
     {
-        return pin.length() == 4 && all_of(pin.begin(), pin.end(), ::isdigit);
+        double vectorTime = timeSeatStore<VectorSeatStore>(seats, rounds);
+        double bitmapTime = timeSeatStore<PooledSeatStore>(seats, rounds);
+        cout << setw(8) << seats << fixed << setprecision(1)
+             << setw(16) << vectorTime << setw(16) << bitmapTime << endl;
     }
-};
+}
 
-// Class for managing the entire booking system
-class BookingSystem
+// Places holds on many shows while the clock moves, confirming some, releasing
+// some and leaving the rest to expire
+void runHoldBenchmark()
 {
-private:
-    vector<Movie> movies;
-    Theater theater;
-    vector<Ticket> bookedTickets;
-
-public:
-    BookingSystem() : theater(50) {} // Assuming the theater has 50 seats
-
-    // Add a movie to the system
-    void addMovie(const Movie &movie)
+    const int showCount = 1000, holdCount = 2000000;
+    ShowInventory inventory;
+    auto hall = HallLayout::grid("Benchmark", 20, 50);
+    for (int i = 0; i < showCount; ++i)
     {
-        movies.push_back(movie);
+        inventory.addShow(hall);
     }
+    SeatHoldTable holds(inventory);
+    mt19937 rng(3);
+    vector<uint64_t> live;
+    uint64_t now = 0;
+    int placed = 0;
 
-    // Show movies sorted by timing
-    void showMoviesToday() const
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < holdCount; ++i)
     {
-        cout << "\nMovies Today (Sorted by Timing):\n";
-        vector<Movie> sortedMovies = movies;
-        sort(sortedMovies.begin(), sortedMovies.end(), [](const Movie &a, const Movie &b)
-             {
-                 return a.timing < b.timing; // Sort by timing
-             });
-        for (const auto &movie : sortedMovies)
+        if (i % 1000 == 0)
         {
-            movie.displayMovieDetails();
+            holds.expire(++now); // One tick per thousand holds
         }
-    }
-
-    // Check currently available seats for a movie and timing
-    bool checkAvailableSeats(const string &movieTitle, const string &timing)
-    {
-        bool movieFound = false;
-        for (const auto &movie : movies)
+        int showId = rng() % showCount;
+        int first = rng() % 997 + 1;
+        vector<int> seats = {first, first + 1, first + 2};
+        uint64_t hold = holds.place(showId, seats, now + 1 + rng() % 600);
+        if (hold == SeatHoldTable::noHold)
+            continue;
+        placed++;
+        switch (rng() % 3)
         {
-            if (movie.title == movieTitle && movie.timing == timing)
-            {
-                movieFound = true;
-                theater.displayAvailableSeats(timing);
-                return true;
-            }
+        case 0:
+            holds.confirm(hold);
+            inventory.cancelSeats(showId, seats); // Cancelled later, so the halls keep churning
+            break;
+        case 1:
+            live.push_back(hold);
+            break;
+        default:
+            break; // Left to expire
         }
-        if (!movieFound)
+        if (live.size() > 64)
         {
-            cout << "Movie not found or invalid timing.\nPlease check movie details." << endl;
-            return false;
+            holds.release(live.front());
+            live.erase(live.begin());
         }
     }
+    holds.expire(now + 1000);
+    auto end = chrono::steady_clock::now();
 
-    // Book tickets
-    // Inside BookingSystem class
+    cout << "Seat holds: " << placed << " placed, " << holds.expired() << " expired, "
+         << fixed << setprecision(1) << chrono::duration<double, nano>(end - start).count() / holdCount
+         << " ns per hold\n";
+}
 
-    void bookTicket(const string &customerName, const string &mobileNumber, const string &movieTitle, const string &timing, const vector<int> &seatNumbers)
+// Loads 100,000 shows into a BookingSystem, then walks them in time order
+void runScheduleBenchmark()
+{
+    const int showCount = 100000;
+    vector<Movie> catalog;
+    for (int i = 0; i < showCount; ++i)
     {
-        if (customerName == "" || mobileNumber == "" || movieTitle == "" || timing == "" || seatNumbers.size() == 0)
-        {
-            cout << "Please enter all the details\n";
-            return;
-        }
-        bool movieFound = false;
-        for (const auto &movie : movies)
-        {
-            if (movie.title == movieTitle && movie.timing == timing)
-            {
-
-                bool alreadyBooked = false;
-                for (const auto &ticket : bookedTickets)
-                {
-                    if (ticket.customerName == customerName && ticket.mobileNumber == mobileNumber)
-                    {
-                        alreadyBooked = true;
-                        break;
-                    }
-                }
+        int minute = (i * 7919) % (24 * 60);
+        int hour = minute / 60 % 12 == 0 ? 12 : minute / 60 % 12;
+        string timing = to_string(hour) + ":" + (minute % 60 < 10 ? "0" : "") + to_string(minute % 60) +
+                        (minute < 12 * 60 ? " AM" : " PM");
+        catalog.push_back(Movie("Movie " + to_string(i), "Drama", 120, timing, 9.5));
+    }
 
-                if (alreadyBooked)
-                {
-                    cout << "You have already booked a ticket\n";
-                    return;
-                }
+    BookingSystem system;
+    auto start = chrono::steady_clock::now();
+    for (const Movie &movie : catalog)
+    {
+        system.addMovie(movie);
+    }
+    auto loaded = chrono::steady_clock::now();
 
-                movieFound = true;
-                double totalPrice = seatNumbers.size() * movie.price; // Calculate total price
+    ScheduleIndex schedule;
+    for (int i = 0; i < showCount; ++i)
+    {
+        schedule.insert(catalog[i].startMinute, i);
+    }
+    long long lastMinute = -1, outOfOrder = 0;
+    auto walkStart = chrono::steady_clock::now();
+    schedule.forEach([&](int position)
+                     {
+        if (catalog[position].startMinute < lastMinute)
+            outOfOrder++;
+        lastMinute = catalog[position].startMinute; });
+    auto walked = chrono::steady_clock::now();
 
-                cout << " can youu further pro  ceed to payment ?(Y/N)\n";
-                char ch;
-                cin >> ch;
-                if (ch == 'N' || ch == 'n')
-                {
-                    cout << "Payment not done\n";
-                    return;
-                }
-                int paymentChoice;
-                cout << "Select payment method:\n1. Cash\n2. Credit Card\nChoice: ";
-                cin >> paymentChoice;
+    cout << "Schedule: loaded " << showCount << " shows in " << fixed << setprecision(1)
+         << chrono::duration<double, milli>(loaded - start).count() << " ms, listed them in "
+         << chrono::duration<double, milli>(walked - walkStart).count() << " ms ("
+         << outOfOrder << " out of order)\n";
+}
 
-                // Process payment based on user choice
-                bool paymentSuccess = false;
-                if (paymentChoice == 1)
-                {
-                    CashPayment cashPayment(totalPrice);
-                    cashPayment.processPayment();
-                    paymentSuccess = true;
-                }
-                else if (paymentChoice == 2)
-                {
-                    CreditCardPayment creditCardPayment(totalPrice);
-                    creditCardPayment.processPayment();
-                    paymentSuccess = true;
-                }
-                else
-                {
-                    cout << "Invalid payment method selected.\n";
-                }
+// Validates and packs 10 million mobile numbers from a bulk import buffer, one
+// per line, first character by character and then with PhoneKey
+void runPhoneBenchmark()
+{
+    const int numberCount = 10000000;
+    mt19937 rng(11);
+    string buffer;
+    buffer.reserve(numberCount * 11);
+    for (int i = 0; i < numberCount; ++i)
+    {
+        string number = to_string(6000000000ULL + rng() % 4000000000ULL);
+        if (rng() % 100 == 0)
+            number[rng() % 10] = "x- /"[rng() % 4]; // About 1% of rows are malformed
+        buffer += number;
+        buffer += '\n';
+    }
 
-                // Only proceed with booking if payment was successful
-                if (paymentSuccess && theater.bookSeats(timing, seatNumbers))
-                {
-                    Ticket ticket(customerName, mobileNumber, movieTitle, timing, seatNumbers, totalPrice);
-                    bookedTickets.push_back(ticket);
-                    cout << "Ticket(s) booked successfully!\n";
-                    ticket.displayTicket();
-                }
-                else
-                {
-                    cout << "Failed to book ticket(s): Payment was not processed, or seats are unavailable.\n";
-                }
-                return;
+    auto scan = [&](auto parse)
+    {
+        uint64_t checksum = 0;
+        int valid = 0;
+        auto start = chrono::steady_clock::now();
+        const char *line = buffer.data(), *end = buffer.data() + buffer.size();
+        while (line < end)
+        {
+            const char *newline = (const char *)memchr(line, '\n', end - line);
+            uint64_t key = parse(line, size_t(newline - line));
+            if (key != PhoneKey::invalid)
+            {
+                checksum += key;
+                valid++;
             }
+            line = newline + 1;
         }
-        if (!movieFound)
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / numberCount;
+        return make_tuple(ns, valid, checksum);
+    };
+
+    auto perCharacter = scan([](const char *text, size_t length) -> uint64_t
+                             {
+        if (length != 10)
+            return PhoneKey::invalid;
+        uint64_t key = 0;
+        for (size_t i = 0; i < length; ++i)
         {
-            cout << "Movie not found or invalid timing.\nPlease check movie details." << endl;
+            if (!isdigit((unsigned char)text[i]))
+                return PhoneKey::invalid;
+            key = key * 10 + (text[i] - '0');
         }
-    }
+        return key; });
+    auto swar = scan(PhoneKey::parse);
 
-    // Cancel tickets
-    void cancelTicket(const string &customerName, const string &mobileNumber, const string &movieTitle, const string &timing, const vector<int> &seatNumbers)
+    cout << "Phone keys: " << numberCount << " numbers, " << get<1>(swar) << " valid"
+         << (get<2>(swar) == get<2>(perCharacter) ? "" : " (MISMATCH)") << ", "
+         << fixed << setprecision(2) << get<0>(perCharacter) << " ns per number character by character, "
+         << get<0>(swar) << " ns with PhoneKey\n";
+}
+
+// Rendering benchmark (run with --bench): prints 100,000 tickets to a file the
+// old way, through the stream with fixed << setprecision and an endl per ticket,
+// and through OutputBuffer with one write per batch of tickets
+void runRenderBenchmark()
+{
+    const int ticketCount = 100000, batchSize = 1000;
+    const char *path = "render_bench.tmp";
+    mt19937 rng(13);
+    vector<Ticket> tickets;
+    for (int i = 0; i < ticketCount; ++i)
     {
-        bool ticketFound = false;
-        for (auto it = bookedTickets.begin(); it != bookedTickets.end(); ++it)
-        {
-            // Check if the ticket details match for cancellation
-            if (it->customerName == customerName && it->mobileNumber == mobileNumber && it->movieTitle == movieTitle && it->movieTiming == timing)
-            {
-                bool allSeatsFound = true;
-                for (int seatNumber : seatNumbers)
-                {
-                    if (find(it->seatNumbers.begin(), it->seatNumbers.end(), seatNumber) == it->seatNumbers.end())
-                    {
-                        allSeatsFound = false;
-                        break;
-                    }
-                }
-                if (allSeatsFound)
-                {
-                    if (theater.cancelSeats(timing, seatNumbers))
-                    {
-                        // Update the total price after cancellation
-                        double pricePerSeat = 0.0; // Initialize price per seat
-                        for (const auto &movie : movies)
-                        {
-                            if (movie.title == movieTitle && movie.timing == timing)
-                            {
-                                pricePerSeat = movie.price; // Get the price for the movie
-                                break;
-                            }
-                        }
+        vector<int> seats;
+        for (int s = 0, n = 1 + rng() % 4; s < n; ++s)
+            seats.push_back(1 + rng() % 300);
+        tickets.push_back(Ticket("Customer " + to_string(rng() % 5000), PhoneKey(to_string(9000000000ULL + rng() % 1000000)),
+                                 "Interstellar", "4:00 PM", seats, seats.size() * 15.0));
+    }
 
-                        // Remove canceled seat numbers from the ticket
-                        for (int seatNumber : seatNumbers)
-                        {
-                            it->seatNumbers.erase(remove(it->seatNumbers.begin(), it->seatNumbers.end(), seatNumber), it->seatNumbers.end());
-                        }
+    auto timeRun = [&](auto render)
+    {
+        ofstream file(path, ios::binary);
+        auto start = chrono::steady_clock::now();
+        render(file);
+        file.close();
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
 
-                        // Update totalPrice based on remaining booked seats
-                        it->totalPrice = it->seatNumbers.size() * pricePerSeat;
+    double streamMs = timeRun([&](ostream &out)
+                              {
+        for (const Ticket &ticket : tickets)
+        {
+            out << "\n--- Ticket Details ---\n";
+            out << "Customer Name: " << symbols.str(ticket.customerName) << "\n"
+                << "Mobile Number: " << ticket.mobileNumber.str() << "\n"
+                << "Movie Title: " << symbols.str(ticket.movieTitle) << "\n"
+                << "Movie Timing: " << symbols.str(ticket.movieTiming) << "\n"
+                << "Seat Numbers: ";
+            for (int seat : ticket.seatNumbers)
+                out << seat << " ";
+            out << "\nTotal Price: $" << fixed << setprecision(2) << ticket.totalPrice << endl;
+        } });
+    ifstream first(path, ios::binary);
+    string streamText((istreambuf_iterator<char>(first)), istreambuf_iterator<char>());
+    first.close();
 
-                        cout << "Ticket(s) cancelled successfully.\n";
-                        it->displayTicket(); // Display updated ticket information
-                    }
-                    else
-                    {
-                        cout << "Failed to cancel ticket(s): Some seats were not booked.\n";
-                    }
-                    ticketFound = true;
-                }
-                else
-                {
-                    cout << "Error: Some seats you entered were not booked under your name.\n";
-                }
-                break;
-            }
-        }
-        if (!ticketFound)
+    OutputBuffer buffer;
+    double bufferMs = timeRun([&](ostream &out)
+                              {
+        for (int i = 0; i < ticketCount; ++i)
         {
-            cout << "Ticket not found. Please check your details.\n";
+            tickets[i].displayTicket(buffer);
+            if ((i + 1) % batchSize == 0)
+                buffer.flush(out);
         }
-    }
+        buffer.flush(out); });
+    ifstream second(path, ios::binary);
+    string bufferText((istreambuf_iterator<char>(second)), istreambuf_iterator<char>());
+    second.close();
+    remove(path);
 
-    void retrieveTicketDetails(const string &customerName, const string &mobileNumber) const
+    cout << "Rendering: " << ticketCount << " tickets, " << fixed << setprecision(1) << streamMs
+         << " ms through the stream with endl, " << bufferMs << " ms through OutputBuffer"
+         << (streamText == bufferText ? "" : " (OUTPUT DIFFERS)") << "\n";
+}
+
+// Import benchmark (run with --bench): a million-row schedule parsed on one
+// thread and on every core, each time into an empty system and symbol table.
+// The global table is set aside meanwhile and put back afterwards
+void runImportBenchmark()
+{
+    const int rowCount = 1000000, titleCount = 5000;
+    const char *path = "import_bench.tmp.csv";
+    const char *genres[] = {"Action", "Sci-Fi", "Drama", "Comedy", "Romance", "Horror", "Animation", "Thriller"};
+    const char *timings[] = {"9:00 AM", "10:30 AM", "12:00 PM", "1:30 PM", "3:00 PM", "4:30 PM",
+                             "6:00 PM", "7:30 PM", "9:00 PM", "10:30 PM"};
+    vector<shared_ptr<const HallLayout>> halls = {HallLayout::grid("Main Hall", 5, 10), HallLayout::grid("Screening Room", 3, 10),
+                                                  HallLayout::grid("Grand Hall", 12, 24, 8)};
     {
-        bool ticketFound = false;
-        for (const auto &ticket : bookedTickets)
+        ofstream out(path, ios::binary);
+        string text = "title,genre,duration,date,timing,hall,price\n";
+        char line[160];
+        for (int i = 0; i < rowCount; i++)
         {
-            if (ticket.customerName == customerName && ticket.mobileNumber == mobileNumber)
+            int title = i % titleCount, slot = i / titleCount; // Every (title, date, timing) once
+            int length = snprintf(line, sizeof(line), "%s%d,%s,%d,2024-%02d-%02d,%s,%s,%d.%02d\n",
+                                  title % 7 == 0 ? "\"Feature, Part " : "Feature ", title, genres[title % 8], 90 + title % 90,
+                                  6 + slot / 300, 1 + slot / 10 % 30, timings[slot % 10], halls[i % 3]->name().c_str(),
+                                  8 + i % 7, i % 4 * 25);
+            if (title % 7 == 0) // Quoted title with a comma in it
             {
-                ticket.displayTicket();
-                ticketFound = true;
+                char *comma = strchr(line, ',');
+                comma = strchr(comma + 1, ','); // The comma after the title
+                memmove(comma + 1, comma, strlen(comma) + 1);
+                *comma = '"';
+                length++;
             }
+            text.append(line, length);
         }
-        if (!ticketFound)
+        out << text;
+    }
+
+    vector<unsigned> threadCounts = {1};
+    if (thread::hardware_concurrency() > 1)
+        threadCounts.push_back(thread::hardware_concurrency());
+    SymbolTable saved = move(symbols);
+    for (unsigned threads : threadCounts)
+    {
+        symbols = SymbolTable();
+        BookingSystem system;
+        auto start = chrono::steady_clock::now();
+        ScheduleImporter::Result result = ScheduleImporter::importFile(path, system, halls, threads);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "Import: " << result.rows << " rows on " << threads << " thread" << (threads == 1 ? "" : "s") << ", "
+             << result.added << " shows added, " << result.errorCount << " errors, " << fixed << setprecision(1)
+             << ms << " ms\n";
+    }
+    symbols = move(saved);
+    remove(path);
+}
+
+// Payment benchmark (run with --bench): bookings paid by card through a
+// gateway that takes 50-100 ms to answer and declines 5%, settled as answers
+// arrive while new bookings keep coming in
+void runPaymentBenchmark()
+{
+    const int showCount = 100, bookingCount = 20000, settleEvery = 500;
+    const auto latency = chrono::milliseconds(50);
+    BookingSystem system;
+    system.setPaymentProvider(make_unique<SimulatedGateway>(latency, 0.05));
+    auto hall = HallLayout::grid("Benchmark", 20, 50);
+    for (int i = 0; i < showCount; ++i)
+    {
+        system.addMovie(Movie("Payment Show " + to_string(i), "Drama", 120, "7:00 PM", 10.0), hall);
+    }
+
+    OutputBuffer receipts; // Rendered, then dropped
+    size_t mostInFlight = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < bookingCount; ++i)
+    {
+        string pin = i % 100 == 0 ? "12a4" : "1234"; // Some cards the gateway will refuse
+        system.placeBooking("Customer " + to_string(i), to_string(9000000000LL + i), "Payment Show " + to_string(i % showCount),
+                            "7:00 PM", {i / showCount + 1}, [&](double total)
+                            { return make_unique<CreditCardPayment>(total, pin); }, receipts);
+        mostInFlight = max(mostInFlight, system.paymentsPending());
+        if ((i + 1) % settleEvery == 0)
         {
-            cout << "No tickets found for the provided name and mobile number.\n";
+            system.settlePayments(receipts);
+            receipts.clear();
         }
     }
+    system.settlePayments(receipts, true);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
 
-    // Validate mobile number
-    bool validateMobileNumber(const string &mobileNumber) const
+    cout << "Payments: " << bookingCount << " card bookings through a " << latency.count() << " ms gateway, up to "
+         << mostInFlight << " in flight, " << system.ticketCount() << " confirmed, " << bookingCount - system.ticketCount()
+         << " declined, " << fixed << setprecision(1) << ms << " ms (" << bookingCount * latency.count() / 1000
+         << " s if each booking waited for its payment)\n";
+
+    const PaymentLedger::Settlement &run = system.runSettlement();
+    cout << "Payments: settlement nets $" << run.netCents() / 100 << '.' << setw(2) << setfill('0') << run.netCents() % 100
+         << setfill(' ') << (run.netCents() == system.ticketRevenueCents() ? ", matching" : ", NOT matching")
+         << " the tickets issued\n";
+}
+
+// Ledger benchmark (run with --bench): a day of 10 million card payments across
+// 20,000 shows, each authorised and captured, a few voided, settled in one run
+void runLedgerBenchmark()
+{
+    const int paymentCount = 10000000, showCount = 20000;
+    PaymentLedger ledger;
+    ledger.reserve(paymentCount * 2 + paymentCount / 50);
+    mt19937 rng(17);
+    long long expected = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < paymentCount; i++)
     {
-        if (mobileNumber.length() != 10)
-            return false; // Check length
-        for (char c : mobileNumber)
+        int showId = rng() % showCount;
+        long long cents = 800 + rng() % 1200;
+        PaymentLedger::Method method = i % 4 == 0 ? PaymentLedger::Cash : PaymentLedger::Card;
+        if (method == PaymentLedger::Card)
+            ledger.record(PaymentLedger::Authorised, method, showId, cents, i + 1);
+        ledger.record(PaymentLedger::Captured, method, showId, cents, method == PaymentLedger::Card ? i + 1 : 0);
+        expected += cents;
+        if (i % 100 == 0)
         {
-            if (!isdigit(c))
-                return false; // Check for digits
+            ledger.record(PaymentLedger::Voided, method, showId, cents, i + 1);
+            expected -= cents;
         }
-        return true;
     }
-};
+    double recordMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    const PaymentLedger::Settlement &run = ledger.settle();
+    double settleMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "Ledger: " << paymentCount << " payments (" << ledger.size() << " entries) recorded in " << fixed
+         << setprecision(1) << recordMs << " ms, settled over " << run.shows.size() << " show/method rows in "
+         << settleMs << " ms" << (run.netCents() == expected ? "" : " (TOTALS WRONG)") << "\n";
+}
 
 // Main Function
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && string(argv[1]) == "--bench")
+    {
+        runSeatBenchmark();
+        runHoldBenchmark();
+        runScheduleBenchmark();
+        runPhoneBenchmark();
+        runRenderBenchmark();
+        runImportBenchmark();
+        runPaymentBenchmark();
+        runLedgerBenchmark();
+        return 0;
+    }
+
     BookingSystem system;
 
     // Adding movies to the system
@@ -408,17 +2647,32 @@ int main()
     system.addMovie(Movie("Interstellar", "Sci-Fi", 170, "4:00 PM", 15.0));
     system.addMovie(Movie("Titanic", "Romance", 195, "7:00 PM", 8.0));
 
+    // om --import schedule.csv adds a whole schedule on top; it may also name
+    // a 30 seat screening room and a larger hall with two aisles
+    if (argc > 2 && string(argv[1]) == "--import")
+    {
+        auto screeningRoom = HallLayout::grid("Screening Room", 3, 10);
+        auto grandHall = HallLayout::grid("Grand Hall", 12, 24, 8);
+        ScheduleImporter::Result result = ScheduleImporter::importFile(argv[2], system, {system.defaultHall(), screeningRoom, grandHall});
+        cout << "Imported " << result.added << " of " << result.rows << " shows (" << result.duplicates << " already listed, "
+             << result.errorCount << " rejected)\n";
+        for (const string &error : result.errors)
+            cout << "  " << error << "\n";
+    }
+
     int choice;
     do
     {
-        cout << "\n--- Movie Ticket Booking System ---\n";
-        cout << "1. Show Movies Today\n";
-        cout << "2. Check Available Seats\n";
-        cout << "3. Book a Ticket\n";
-        cout << "4. Cancel a Ticket\n";
-        cout << "5. Retrieve Ticket Details\n";
-        cout << "6. Exit\n";
-        cout << "Enter your choice: ";
+        system.settlePayments(); // Report payments that cleared since the last choice
+        screen << "\n--- Movie Ticket Booking System ---\n"
+               << "1. Show Movies Today\n"
+               << "2. Check Available Seats\n"
+               << "3. Book a Ticket\n"
+               << "4. Cancel a Ticket\n"
+               << "5. Retrieve Ticket Details\n"
+               << "6. Exit\n"
+               << "Enter your choice: ";
+        screen.flush();
         cin >> choice;
         cin.ignore(); // Clear newline character after choice
 
@@ -453,7 +2707,7 @@ int main()
                 }
                 else
                 {
-                    cout << "Please enter a valid mobile number." << endl;
+                    cout << "Please enter a valid mobile number.\n";
                 }
             }
 
@@ -499,7 +2753,7 @@ int main()
                 }
                 else
                 {
-                    cout << "Please enter a valid mobile number." << endl;
+                    cout << "Please enter a valid mobile number.\n";
                 }
             }
 
@@ -532,5 +2786,13 @@ int main()
         }
     } while (choice != 6);
 
+    if (system.paymentsPending() > 0)
+    {
+        cout << "Waiting for payments still in flight...\n";
+        system.settlePayments(screen, true);
+    }
+    if (system.paymentLedger().unsettled() > 0)
+        system.printSettlement(system.runSettlement()); // End of day
+    screen.flush();
     return 0;
 }
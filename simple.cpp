@@ -1,46 +1,299 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <iomanip>
 #include <algorithm>
-#include <set>
+#include <atomic>
+#include <optional>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <random>
 
 using namespace std;
 
-class Movie
+// Seat map that many threads can book from at once. One bit per seat (set = free)
+// packed into 64-bit atomic words; a booking claims all of its seats with
+// compare-and-swap, one word at a time, and rolls back if any seat is gone.
+class AtomicSeatMap
 {
+private:
+    unique_ptr<atomic<uint64_t>[]> words;
+    size_t wordCount;
+    int totalSeats;
+
+    // Groups seat numbers into (word index, bit mask) pairs, in word order
+    static bool buildMasks(const vector<int> &seatNumbers, int totalSeats, vector<pair<size_t, uint64_t>> &masks)
+    {
+        for (int seat : seatNumbers)
+        {
+            if (seat < 1 || seat > totalSeats)
+                return false;
+            masks.push_back({size_t(seat - 1) >> 6, 1ULL << ((seat - 1) & 63)});
+        }
+        sort(masks.begin(), masks.end());
+        size_t out = 0;
+        for (size_t i = 0; i < masks.size(); i++)
+        {
+            if (out > 0 && masks[out - 1].first == masks[i].first)
+                masks[out - 1].second |= masks[i].second;
+            else
+                masks[out++] = masks[i];
+        }
+        masks.resize(out);
+        return true;
+    }
+
 public:
-    string title, timing;
-    double pricePerSeat;
-    vector<bool> seats;
+    AtomicSeatMap(int seatCount)
+        : words(new atomic<uint64_t>[(seatCount + 63) / 64]), wordCount((seatCount + 63) / 64), totalSeats(seatCount)
+    {
+        for (size_t w = 0; w < wordCount; w++)
+        {
+            words[w].store(~0ULL, memory_order_relaxed);
+        }
+        if (seatCount % 64 != 0)
+        {
+            words[wordCount - 1].store((1ULL << (seatCount % 64)) - 1, memory_order_relaxed);
+        }
+    }
+
+    int size() const { return totalSeats; }
+
+    bool isFree(int seat) const
+    {
+        return (words[(seat - 1) >> 6].load(memory_order_acquire) >> ((seat - 1) & 63)) & 1ULL;
+    }
+
+    // Claims every seat in seatNumbers, or none of them
+    bool claimAll(const vector<int> &seatNumbers)
+    {
+        static thread_local vector<pair<size_t, uint64_t>> masks; // Reused so booking does not allocate
+        masks.clear();
+        if (!buildMasks(seatNumbers, totalSeats, masks))
+            return false;
+
+        for (size_t i = 0; i < masks.size(); i++)
+        {
+            atomic<uint64_t> &word = words[masks[i].first];
+            uint64_t mask = masks[i].second;
+            uint64_t current = word.load(memory_order_relaxed);
+            do
+            {
+                if ((current & mask) != mask)
+                {
+                    // Someone else holds one of these seats: give back what we took
+                    for (size_t j = 0; j < i; j++)
+                    {
+                        words[masks[j].first].fetch_or(masks[j].second, memory_order_release);
+                    }
+                    return false;
+                }
+            } while (!word.compare_exchange_weak(current, current & ~mask, memory_order_acq_rel, memory_order_relaxed));
+        }
+        return true;
+    }
+
+    // Frees one seat, returns false if it was not booked
+    bool release(int seat)
+    {
+        if (seat < 1 || seat > totalSeats)
+            return false;
+        uint64_t mask = 1ULL << ((seat - 1) & 63);
+        return !(words[(seat - 1) >> 6].fetch_or(mask, memory_order_acq_rel) & mask);
+    }
+};
+
+// Spreads the bits of an integer key for open-addressing tables (splitmix64 finaliser)
+inline size_t mixHash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    return key ^ (key >> 33);
+}
+
+// Id of a string in the global symbol table
+typedef uint32_t Symbol;
+
+// Global symbol table: every distinct title, timing and customer name is
+// stored once and referred to by a 32-bit id, so comparing two of them
+// is an integer compare. Lookups of known strings go through an open-addressing
+// table and never allocate.
+class SymbolTable
+{
+private:
+    vector<string> strings;
+    vector<Symbol> slots; // Symbol + 1, 0 = empty; size is a power of two
+    size_t textBytes = 0;
+
+    static uint64_t hashOf(string_view s)
+    {
+        uint64_t h = 14695981039346656037ULL; // FNV-1a
+        for (unsigned char c : s)
+        {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+        return h;
+    }
 
-    Movie(string t, string time, double p) : title(t), timing(time), pricePerSeat(p)
+    // Slot holding s, or the empty slot where it would go
+    size_t probe(string_view s) const
     {
-        seats.resize(50, true); // 50 seats initially available
+        size_t mask = slots.size() - 1;
+        size_t i = hashOf(s) & mask;
+        while (slots[i] != 0 && strings[slots[i] - 1] != s)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        slots.assign(max<size_t>(16, slots.size() * 2), 0);
+        for (size_t id = 0; id < strings.size(); id++)
+        {
+            slots[probe(strings[id])] = id + 1;
+        }
+    }
+
+public:
+    static const Symbol none = ~0u;
+
+    // Id of s, or none if it was never interned
+    Symbol find(string_view s) const
+    {
+        if (slots.empty())
+            return none;
+        return slots[probe(s)] - 1;
+    }
+
+    Symbol intern(string_view s)
+    {
+        if ((strings.size() + 1) * 2 > slots.size())
+            grow();
+        size_t i = probe(s);
+        if (slots[i] == 0)
+        {
+            strings.emplace_back(s);
+            slots[i] = strings.size();
+            textBytes += strings.back().capacity() > 15 ? strings.back().capacity() + 1 : 0; // Heap part, beyond the inline buffer
+        }
+        return slots[i] - 1;
     }
 
+    const string &str(Symbol id) const { return strings[id]; }
+
+    size_t size() const { return strings.size(); }
+
+    // Bytes held by the table: the strings, their text and the hash slots
+    size_t memoryUsage() const
+    {
+        return strings.capacity() * sizeof(string) + textBytes + slots.capacity() * sizeof(Symbol);
+    }
+};
+
+SymbolTable symbols;
+
+// A 10 digit mobile number packed into an integer. Validation and packing
+// run on 8 digits at a time inside a 64-bit word (SWAR), so checking a
+// number is a few arithmetic ops with no per-character branches. Assumes a
+// little-endian target.
+class PhoneKey
+{
+private:
+    uint64_t value;
+
+    // True if all 8 bytes of chunk are ASCII digits
+    static bool eightDigits(uint64_t chunk)
+    {
+        return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+                (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+    }
+
+    // The 8 digits in chunk as a number, first character most significant
+    static uint32_t eightDigitValue(uint64_t chunk)
+    {
+        chunk = (chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+        chunk = (chunk & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+        return uint32_t((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+    }
+
+public:
+    static const uint64_t invalid = ~0ULL;
+
+    PhoneKey() : value(invalid) {}
+    explicit PhoneKey(string_view mobile) : value(parse(mobile.data(), mobile.size())) {}
+
+    // The number in text[0..length), or invalid unless it is exactly 10 digits
+    static uint64_t parse(const char *text, size_t length)
+    {
+        if (length != 10)
+            return invalid;
+        uint64_t chunk;
+        memcpy(&chunk, text, 8);
+        unsigned d8 = (unsigned char)text[8] - '0', d9 = (unsigned char)text[9] - '0';
+        if (!eightDigits(chunk) || d8 > 9 || d9 > 9)
+            return invalid;
+        return uint64_t(eightDigitValue(chunk)) * 100 + d8 * 10 + d9;
+    }
+
+    bool valid() const { return value != invalid; }
+    uint64_t packed() const { return value; }
+
+    // Back to the 10 digit text, keeping leading zeros
+    string str() const
+    {
+        if (!valid())
+            return "";
+        string text(10, '0');
+        uint64_t rest = value;
+        for (int i = 9; i >= 0; i--)
+        {
+            text[i] = '0' + rest % 10;
+            rest /= 10;
+        }
+        return text;
+    }
+
+    bool operator==(const PhoneKey &other) const { return value == other.value; }
+    bool operator!=(const PhoneKey &other) const { return value != other.value; }
+};
+
+class Movie
+{
+public:
+    Symbol title, timing;
+    double pricePerSeat;
+    AtomicSeatMap seats;
+
+    Movie(string_view t, string_view time, double p, int seatCount)
+        : title(symbols.intern(t)), timing(symbols.intern(time)), pricePerSeat(p), seats(seatCount) {}
+
     void display() const
     {
-        cout << "Title: " << title << ", Timing: " << timing << ", Price: $" << fixed << setprecision(2) << pricePerSeat << endl;
+        cout << "Title: " << symbols.str(title) << ", Timing: " << symbols.str(timing) << ", Price: $" << fixed << setprecision(2) << pricePerSeat << endl;
     }
 
     void showAvailableSeats() const
     {
         cout << "Available seats: ";
-        for (int i = 0; i < seats.size(); i++)
+        for (int i = 1; i <= seats.size(); i++)
         {
-            if (seats[i])
-                cout << i + 1 << " ";
+            if (seats.isFree(i))
+                cout << i << " ";
         }
         cout << endl;
     }
 
-    void bookSeats(const vector<int> &seatNumbers)
+    // Books all the seats or none of them; safe to call from several threads
+    bool bookSeats(const vector<int> &seatNumbers)
     {
-        for (int seat : seatNumbers)
-        {
-            seats[seat - 1] = false; // Mark seat as booked
-        }
+        return seats.claimAll(seatNumbers);
     }
 
     void cancelSeats(const vector<int> &seatNumbers)
@@ -48,44 +301,204 @@ public:
         cout << "Cancelling seats: ";
         for (int seat : seatNumbers)
         {
-            if (!seats[seat - 1]) // Only cancel if the seat is booked
+            if (seats.release(seat)) // Only cancel if the seat is booked
             {
-                seats[seat - 1] = true;
                 cout << seat << " ";
             }
         }
         cout << endl;
     }
+};
 
-    bool checkBookSeats(const vector<int> &seatNumbers) const
+// Seats held by one ticket. Up to 8 seats live sorted in an inline array,
+// with unused slots set to a sentinel, so a lookup compares all 8 slots
+// without branching. A ticket with more seats spills to a bitmap indexed by
+// seat number, which never grows past the hall it was booked in. Neither
+// form allocates per seat.
+class SeatSet
+{
+private:
+    static const int inlineCapacity = 8;
+    static const int unused = INT32_MAX; // Sorts after every real seat
+
+    int count = 0;
+    int small[inlineCapacity] = {unused, unused, unused, unused, unused, unused, unused, unused};
+    vector<uint64_t> words; // Non-empty once spilled; bit s is seat s
+
+    bool spilled() const { return !words.empty(); }
+
+    bool bitmapHas(int seat) const
     {
+        size_t w = size_t(seat) >> 6;
+        return seat >= 0 && w < words.size() && (words[w] >> (seat & 63) & 1);
+    }
+
+    void spill(int seat)
+    {
+        words.assign(size_t(max(seat, small[count - 1])) / 64 + 1, 0);
+        for (int i = 0; i < count; i++)
+        {
+            words[size_t(small[i]) >> 6] |= 1ULL << (small[i] & 63);
+            small[i] = unused;
+        }
+    }
+
+    // First seat at or after `seat`, or the end position
+    int nextSeat(int seat) const
+    {
+        size_t w = size_t(seat) >> 6;
+        if (w >= words.size())
+            return int(words.size() * 64);
+        uint64_t word = words[w] & (~0ULL << (seat & 63));
+        while (word == 0)
+        {
+            if (++w == words.size())
+                return int(words.size() * 64);
+            word = words[w];
+        }
+        return int(w * 64) + __builtin_ctzll(word);
+    }
+
+public:
+    class const_iterator
+    {
+    private:
+        const SeatSet *seats;
+        int position; // Slot while inline, seat number once spilled
+
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef int reference;
+
+        const_iterator(const SeatSet *s, int p) : seats(s), position(p) {}
+        int operator*() const { return seats->spilled() ? position : seats->small[position]; }
+        const_iterator &operator++()
+        {
+            position = seats->spilled() ? seats->nextSeat(position + 1) : position + 1;
+            return *this;
+        }
+        bool operator!=(const const_iterator &other) const { return position != other.position; }
+        bool operator==(const const_iterator &other) const { return position == other.position; }
+    };
+
+    SeatSet() {}
+
+    template <typename It>
+    SeatSet(It first, It last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    bool contains(int seat) const
+    {
+        if (spilled())
+            return bitmapHas(seat);
+        bool hit = false;
+        for (int i = 0; i < inlineCapacity; i++)
+            hit |= (small[i] == seat) & (i < count); // Empty slots hold `unused`, which is also a valid int
+        return hit;
+    }
+
+    // True if every seat in the range is in the set
+    template <typename Range>
+    bool containsAll(const Range &seatNumbers) const
+    {
+        bool all = true;
         for (int seat : seatNumbers)
+            all &= contains(seat);
+        return all;
+    }
+
+    // Adds a seat; false if it was already there or is not a seat number (< 1)
+    bool insert(int seat)
+    {
+        if (seat < 1 || contains(seat))
+            return false;
+        if (!spilled() && count == inlineCapacity)
+            spill(seat);
+        if (spilled())
         {
-            if (!seats[seat - 1]) // Check if the seat is already booked
-                return false;
+            if (size_t(seat) / 64 >= words.size())
+                words.resize(size_t(seat) / 64 + 1, 0);
+            words[size_t(seat) >> 6] |= 1ULL << (seat & 63);
+        }
+        else
+        {
+            int i = count;
+            while (i > 0 && small[i - 1] > seat) // Insertion sort keeps the slots ordered
+            {
+                small[i] = small[i - 1];
+                i--;
+            }
+            small[i] = seat;
+        }
+        count++;
+        return true;
+    }
+
+    template <typename It>
+    void insert(It first, It last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    // Removes a seat; false if it was not there
+    bool erase(int seat)
+    {
+        if (!contains(seat))
+            return false;
+        if (spilled())
+        {
+            words[size_t(seat) >> 6] &= ~(1ULL << (seat & 63));
         }
+        else
+        {
+            int i = 0;
+            while (small[i] != seat)
+                i++;
+            for (; i < count - 1; i++)
+                small[i] = small[i + 1];
+            small[count - 1] = unused;
+        }
+        count--;
         return true;
     }
+
+    const_iterator begin() const { return const_iterator(this, spilled() ? nextSeat(0) : 0); }
+    const_iterator end() const { return const_iterator(this, spilled() ? int(words.size() * 64) : count); }
 };
 
 class Ticket
 {
 public:
-    string customerName, mobileNumber, movieTitle, movieTiming;
-    set<int> bookedSeats;
+    Symbol customerName;
+    PhoneKey mobileNumber;
+    Symbol movieTitle, movieTiming;
+    SeatSet bookedSeats;
     double totalPrice;
 
-    Ticket(string name, string mobile, string title, string time, const vector<int> &seats, double pricePerSeat)
+    Ticket(Symbol name, PhoneKey mobile, Symbol title, Symbol time, const vector<int> &seats, double pricePerSeat)
         : customerName(name), mobileNumber(mobile), movieTitle(title), movieTiming(time)
     {
         bookedSeats.insert(seats.begin(), seats.end());
         totalPrice = bookedSeats.size() * pricePerSeat;
     }
 
+    Ticket(string_view name, PhoneKey mobile, string_view title, string_view time, const vector<int> &seats, double pricePerSeat)
+        : Ticket(symbols.intern(name), mobile, symbols.intern(title), symbols.intern(time), seats, pricePerSeat) {}
+
     void display() const
     {
-        cout << "\n--- Ticket Details ---\nName: " << customerName << "\nMobile: " << mobileNumber
-             << "\nMovie: " << movieTitle << "\nTiming: " << movieTiming << "\nSeats: ";
+        cout << "\n--- Ticket Details ---\nName: " << symbols.str(customerName) << "\nMobile: " << mobileNumber.str()
+             << "\nMovie: " << symbols.str(movieTitle) << "\nTiming: " << symbols.str(movieTiming) << "\nSeats: ";
         for (int seat : bookedSeats)
             cout << seat << " ";
         cout << "\nTotal Price: $" << fixed << setprecision(2) << totalPrice << endl;
@@ -115,32 +528,260 @@ public:
 
     bool checkCancel(const vector<int> &seatNumbers) const
     {
-        for (int seat : seatNumbers)
+        return bookedSeats.containsAll(seatNumbers);
+    }
+
+    bool allSeatsCancel(const vector<int> &seatNumbers) const
+    {
+        return checkCancel(seatNumbers) && seatNumbers.size() == bookedSeats.size();
+    }
+};
+
+// Tickets in a generational slot map. A handle is a slot's generation in the
+// high 32 bits and its index in the low 32. Erasing bumps the generation and
+// puts the slot on a free list, so erase is O(1) with nothing shifting, and a
+// stale handle gets nullptr from get() instead of whichever ticket reuses the
+// slot later.
+class TicketSlotMap
+{
+private:
+    static const uint32_t endOfList = ~0u;
+
+    struct Slot
+    {
+        uint32_t generation = 1; // 0 is never issued, so handle 0 is never valid
+        uint32_t nextFree = endOfList;
+        optional<Ticket> ticket;
+    };
+
+    vector<Slot> slots;
+    uint32_t freeHead = endOfList;
+    size_t live = 0;
+
+public:
+    typedef uint64_t Handle;
+    static const Handle none = 0;
+
+    static uint32_t indexOf(Handle handle) { return uint32_t(handle); }
+
+    // Handle of whatever currently lives in a slot
+    Handle handleAt(uint32_t index) const { return (uint64_t(slots[index].generation) << 32) | index; }
+
+    Handle insert(Ticket ticket)
+    {
+        uint32_t index;
+        if (freeHead != endOfList)
         {
-            if (bookedSeats.find(seat) == bookedSeats.end())
-            {
-                return false;
-            }
+            index = freeHead;
+            freeHead = slots[index].nextFree;
+        }
+        else
+        {
+            index = slots.size();
+            slots.emplace_back();
         }
+        slots[index].ticket.emplace(std::move(ticket));
+        live++;
+        return handleAt(index);
+    }
+
+    Ticket *get(Handle handle)
+    {
+        uint32_t index = indexOf(handle);
+        if (index >= slots.size() || slots[index].generation != uint32_t(handle >> 32) || !slots[index].ticket)
+            return nullptr;
+        return &*slots[index].ticket;
+    }
+
+    const Ticket *get(Handle handle) const
+    {
+        return const_cast<TicketSlotMap *>(this)->get(handle);
+    }
+
+    bool erase(Handle handle)
+    {
+        if (!get(handle))
+            return false;
+        Slot &slot = slots[indexOf(handle)];
+        slot.ticket.reset();
+        if (++slot.generation == 0)
+            slot.generation = 1;
+        slot.nextFree = freeHead;
+        freeHead = indexOf(handle);
+        live--;
         return true;
     }
 
-    bool allSeatsCancel(const vector<int> &seatNumbers) const
+    size_t size() const { return live; }
+};
+
+// Open-addressing index from a (title, timing) symbol pair to a movie's
+// position in the movies vector
+class ShowIndex
+{
+private:
+    struct Slot
     {
-        return checkCancel(seatNumbers) && seatNumbers.size() == bookedSeats.size();
+        uint64_t key;
+        int position; // -1 = empty
+    };
+
+    vector<Slot> slots; // Size is a power of two, at most half full
+    size_t used = 0;
+
+    static uint64_t keyOf(Symbol title, Symbol timing)
+    {
+        return (uint64_t(title) << 32) | timing;
+    }
+
+    size_t probe(uint64_t key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = mixHash(key) & mask;
+        while (slots[i].position >= 0 && slots[i].key != key)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        vector<Slot> old = slots;
+        slots.assign(max<size_t>(16, old.size() * 2), Slot{0, -1});
+        for (const Slot &slot : old)
+        {
+            if (slot.position >= 0)
+                slots[probe(slot.key)] = slot;
+        }
+    }
+
+public:
+    // Adds a show; the first movie added for a title and timing wins
+    void insert(Symbol title, Symbol timing, int position)
+    {
+        if ((used + 1) * 2 > slots.size())
+            grow();
+        uint64_t key = keyOf(title, timing);
+        size_t i = probe(key);
+        if (slots[i].position < 0)
+        {
+            slots[i] = Slot{key, position};
+            used++;
+        }
+    }
+
+    // Position of the movie, or -1 if there is no such show
+    int find(Symbol title, Symbol timing) const
+    {
+        if (title == SymbolTable::none || timing == SymbolTable::none || slots.empty())
+            return -1;
+        return slots[probe(keyOf(title, timing))].position;
     }
 };
 
+// Secondary index from a customer's mobile number, as a PhoneKey, to the
+// slots of their tickets in the TicketSlotMap. Open addressing on the packed key; each customer
+// has only a few tickets, so lookup, insert and remove are O(1) amortised.
+class CustomerTicketIndex
+{
+private:
+    struct Slot
+    {
+        uint64_t key;
+        int list; // Index into lists, -1 = empty slot
+    };
+
+    vector<Slot> slots; // Size is a power of two, at most half full
+    vector<vector<int>> lists;
+
+    size_t probe(uint64_t key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = mixHash(key) & mask;
+        while (slots[i].list >= 0 && slots[i].key != key)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        vector<Slot> old = slots;
+        slots.assign(max<size_t>(16, old.size() * 2), Slot{0, -1});
+        for (const Slot &slot : old)
+        {
+            if (slot.list >= 0)
+                slots[probe(slot.key)] = slot;
+        }
+    }
+
+    vector<int> *listFor(uint64_t key)
+    {
+        if (slots.empty())
+            return nullptr;
+        size_t i = probe(key);
+        return slots[i].list >= 0 ? &lists[slots[i].list] : nullptr;
+    }
+
+public:
+    void insert(PhoneKey mobile, int ticket)
+    {
+        uint64_t key = mobile.packed();
+        if ((lists.size() + 1) * 2 > slots.size())
+            grow();
+        size_t i = probe(key);
+        if (slots[i].list < 0)
+        {
+            slots[i] = Slot{key, (int)lists.size()};
+            lists.emplace_back();
+        }
+        lists[slots[i].list].push_back(ticket);
+    }
+
+    void remove(PhoneKey mobile, int ticket)
+    {
+        vector<int> *list = listFor(mobile.packed());
+        if (!list)
+            return;
+        auto it = std::find(list->begin(), list->end(), ticket);
+        if (it != list->end())
+        {
+            *it = list->back();
+            list->pop_back();
+        }
+    }
+
+    // Positions of every ticket booked with this mobile number
+    const vector<int> &find(PhoneKey mobile) const
+    {
+        static const vector<int> none;
+        if (slots.empty())
+            return none;
+        size_t i = probe(mobile.packed());
+        return slots[i].list >= 0 ? lists[slots[i].list] : none;
+    }
+};
 
 class BookingSystem
 {
     vector<Movie> movies;
-    vector<Ticket> tickets;
+    TicketSlotMap tickets;
+    ShowIndex showIndex;             // (title, timing) -> position in movies
+    CustomerTicketIndex ticketIndex; // Mobile number -> slots in tickets
+
+    void removeTicket(TicketSlotMap::Handle handle)
+    {
+        ticketIndex.remove(tickets.get(handle)->mobileNumber, TicketSlotMap::indexOf(handle));
+        tickets.erase(handle);
+    }
 
 public:
-    void addMovie(string title, string timing, double price)
+    void addMovie(string_view title, string_view timing, double price, int seatCount = 50)
     {
-        movies.push_back(Movie(title, timing, price));
+        movies.push_back(Movie(title, timing, price, seatCount));
+        showIndex.insert(movies.back().title, movies.back().timing, movies.size() - 1);
     }
 
     void showMovies() const
@@ -153,12 +794,15 @@ public:
 
     Movie *getMovie(const string &title, const string &time)
     {
-        for (auto &movie : movies)
-        {
-            if (movie.title == title && movie.timing == time)
-                return &movie;
-        }
-        return nullptr; // Movie not found
+        return getMovie(symbols.find(title), symbols.find(time));
+    }
+
+    Movie *getMovie(Symbol title, Symbol time)
+    {
+        int position = showIndex.find(title, time);
+        if (position < 0)
+            return nullptr; // Movie not found
+        return &movies[position];
     }
 
     void showAvailableSeats(const string &title, const string &time)
@@ -174,17 +818,56 @@ public:
         }
     }
 
-    void bookTicket(string name, string mobile, string title, string time, const vector<int> &seats)
+    // Programmatic API: names and shows are resolved to ids once, and booking or
+    // cancelling through the ids copies no strings. Once the ticket store has
+    // grown to its working size these calls make no heap allocations.
+
+    // Position of a show for book(), or -1
+    int findShow(string_view title, string_view time) const
     {
-        Movie *movie = getMovie(title, time);
-        if (movie)
+        return showIndex.find(symbols.find(title), symbols.find(time));
+    }
+
+    // Claims the seats and records the ticket; none if any seat is taken
+    TicketSlotMap::Handle book(Symbol customer, PhoneKey mobile, int show, const vector<int> &seats)
+    {
+        Movie &movie = movies[show];
+        if (!movie.bookSeats(seats)) // Claims the seats only if all are available
+            return TicketSlotMap::none;
+        TicketSlotMap::Handle handle = tickets.insert(Ticket(customer, mobile, movie.title, movie.timing, seats, movie.pricePerSeat));
+        ticketIndex.insert(mobile, TicketSlotMap::indexOf(handle));
+        return handle;
+    }
+
+    // Gives back some or all of a ticket's seats; false if the handle is stale
+    // or a seat is not on the ticket
+    bool cancel(TicketSlotMap::Handle handle, const vector<int> &seats)
+    {
+        Ticket *ticket = tickets.get(handle);
+        if (!ticket || !ticket->checkCancel(seats))
+            return false;
+        Movie *movie = getMovie(ticket->movieTitle, ticket->movieTiming);
+        for (int seat : seats)
+            movie->seats.release(seat);
+        if (ticket->allSeatsCancel(seats))
+            removeTicket(handle);
+        else
+            ticket->removeSeats(seats, movie->pricePerSeat);
+        return true;
+    }
+
+    const Ticket *ticket(TicketSlotMap::Handle handle) const { return tickets.get(handle); }
+
+    void bookTicket(const string &name, PhoneKey mobile, const string &title, const string &time, const vector<int> &seats)
+    {
+        int show = findShow(title, time);
+        if (show >= 0)
         {
-            if (movie->checkBookSeats(seats)) // Check if seats are available
+            TicketSlotMap::Handle handle = book(symbols.intern(name), mobile, show, seats);
+            if (handle != TicketSlotMap::none)
             {
-                movie->bookSeats(seats);
-                tickets.push_back(Ticket(name, mobile, title, time, seats, movie->pricePerSeat));
                 cout << "Booking successful!\n";
-                tickets.back().display();
+                tickets.get(handle)->display();
             }
             else
             {
@@ -197,19 +880,21 @@ public:
         }
     }
 
-    void cancelTicket(string name, string mobile, string title, const vector<int> &seats)
+    void cancelTicket(const string &name, PhoneKey mobile, const string &title, const vector<int> &seats)
     {
-        Ticket *ticket = getTicket(name, mobile, title);
+        TicketSlotMap::Handle handle = getTicket(name, mobile, title);
+        Ticket *ticket = tickets.get(handle);
         if (ticket)
         {
-            Movie *movie = getMovie(title, ticket->movieTiming);
+            Movie *movie = getMovie(ticket->movieTitle, ticket->movieTiming);
             if (movie)
             {
                 if (ticket->checkCancel(seats))
                 {
                     if (ticket->allSeatsCancel(seats))
                     {
-                    tickets.erase(remove(tickets.begin(), tickets.end(), *ticket), tickets.end());
+                        movie->cancelSeats(seats);
+                        removeTicket(handle);
                     }
                     else
                     {
@@ -233,21 +918,27 @@ public:
         }
     }
 
-    Ticket *getTicket(const string &name, const string &mobile, const string &title)
+    // Handle of the customer's ticket for a title, or TicketSlotMap::none
+    TicketSlotMap::Handle getTicket(const string &name, PhoneKey mobile, const string &title) const
     {
-        for (auto &ticket : tickets)
+        Symbol nameId = symbols.find(name), titleId = symbols.find(title);
+        if (nameId == SymbolTable::none || titleId == SymbolTable::none)
+            return TicketSlotMap::none; // Never interned, so no ticket can carry it
+        for (int slot : ticketIndex.find(mobile))
         {
-            if (ticket.customerName == name && ticket.mobileNumber == mobile && ticket.movieTitle == title)
+            TicketSlotMap::Handle handle = tickets.handleAt(slot);
+            const Ticket *ticket = tickets.get(handle);
+            if (ticket->customerName == nameId && ticket->movieTitle == titleId)
             {
-                return &ticket; // Found the ticket
+                return handle; // Found the ticket
             }
         }
-        return nullptr; // Ticket not found
+        return TicketSlotMap::none; // Ticket not found
     }
 
-    void retrieveTicket(const string &name, const string &title, const string &mobile)
+    void retrieveTicket(const string &name, const string &title, PhoneKey mobile)
     {
-        const Ticket *ticket = getTicket(name, mobile, title);
+        const Ticket *ticket = tickets.get(getTicket(name, mobile, title));
         if (ticket)
         {
             ticket->display();
@@ -260,9 +951,7 @@ public:
     }
 bool isValidPhoneNumber(const string &mobile)
 {
-    if (mobile.length() != 10)
-        return false;
-    return all_of(mobile.begin(), mobile.end(), ::isdigit);
+    return PhoneKey(mobile).valid();
 }
 
     void run_choice_2() // Book Ticket
@@ -287,7 +976,7 @@ bool isValidPhoneNumber(const string &mobile)
         cout << "Enter seat numbers (end with -1): ";
         while (cin >> seat && seat != -1)
             seats.push_back(seat);
-        bookTicket(name, mobile, title, time, seats);
+        bookTicket(name, PhoneKey(mobile), title, time, seats);
     }
 
     void run_choice_3() // Cancel Ticket
@@ -310,7 +999,7 @@ bool isValidPhoneNumber(const string &mobile)
         cout << "Enter seat numbers to cancel (end with -1): ";
         while (cin >> seat && seat != -1)
             seats.push_back(seat);
-        cancelTicket(name, mobile, title, seats);
+        cancelTicket(name, PhoneKey(mobile), title, seats);
     }
 
     void run_choice_4() // Show Available Seats
@@ -335,12 +1024,269 @@ bool isValidPhoneNumber(const string &mobile)
         getline(cin, title);
         cout << "Enter mobile: ";
         cin >> mobile;
-        retrieveTicket(name, title, mobile);
+        retrieveTicket(name, title, PhoneKey(mobile));
     }
 };
 
-int main()
+// Concurrency stress test (run with --stress): many threads book and cancel random
+// seat groups on the same show, and every seat must be held by at most one of them
+int runBookingStressTest()
 {
+    const int threadCount = 32;
+    const int attemptsPerThread = 50000;
+    Movie movie("Avengers", "10:00 AM", 10.0, 50);
+    vector<atomic<int>> holders(movie.seats.size() + 1);
+    atomic<long long> booked(0), rejected(0), doubleSells(0);
+
+    vector<thread> workers;
+    for (int t = 0; t < threadCount; t++)
+    {
+        workers.emplace_back([&, t]()
+                             {
+            mt19937 rng(t + 1);
+            uniform_int_distribution<int> firstSeat(1, movie.seats.size() - 3);
+            uniform_int_distribution<int> groupSize(1, 4);
+            vector<vector<int>> mine;
+            for (int i = 0; i < attemptsPerThread; i++)
+            {
+                int first = firstSeat(rng);
+                vector<int> seats;
+                for (int k = groupSize(rng) - 1; k >= 0; k--)
+                    seats.push_back(first + k);
+
+                if (movie.bookSeats(seats))
+                {
+                    booked++;
+                    for (int seat : seats)
+                    {
+                        if (holders[seat].fetch_add(1) != 0)
+                            doubleSells++;
+                    }
+                    mine.push_back(seats);
+                }
+                else
+                {
+                    rejected++;
+                }
+
+                // Give seats back now and then so the show keeps churning
+                if (!mine.empty() && rng() % 2 == 0)
+                {
+                    for (int seat : mine.back())
+                    {
+                        holders[seat].fetch_sub(1);
+                        movie.seats.release(seat);
+                    }
+                    mine.pop_back();
+                }
+            }
+            for (const auto &seats : mine)
+            {
+                for (int seat : seats)
+                {
+                    holders[seat].fetch_sub(1);
+                    movie.seats.release(seat);
+                }
+            } });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    int leftBooked = 0;
+    for (int seat = 1; seat <= movie.seats.size(); seat++)
+    {
+        if (!movie.seats.isFree(seat))
+            leftBooked++;
+    }
+    cout << threadCount << " threads, " << booked << " bookings, " << rejected << " rejected, "
+         << doubleSells << " double-sold seats, " << leftBooked << " seats left booked\n";
+    return (doubleSells == 0 && leftBooked == 0) ? 0 : 1;
+}
+
+// Books a million tickets over a realistic mix of shows and customers and
+// compares the string part of a ticket before and after interning
+int runMemoryReport()
+{
+    const int ticketCount = 1000000;
+    const char *titles[] = {"Avengers: Endgame", "Inception", "The Shawshank Redemption", "Interstellar",
+                            "Spider-Man: Across the Spider-Verse", "Oppenheimer", "Dune: Part Two", "Up"};
+    const char *timings[] = {"10:00 AM", "1:00 PM", "4:30 PM", "7:00 PM", "10:15 PM"};
+    mt19937 rng(7);
+
+    // Heap bytes a std::string needs beyond its own object (0 when it fits inline)
+    auto heapBytes = [](const string &s) -> size_t
+    { return s.size() > 15 ? s.size() + 1 : 0; };
+
+    vector<Ticket> tickets;
+    tickets.reserve(ticketCount);
+    size_t stringBytes = 0; // What four string copies per ticket would have cost
+    for (int i = 0; i < ticketCount; i++)
+    {
+        int customer = rng() % 200000; // Repeat customers book several shows
+        string name = "Customer Number " + to_string(customer);
+        string mobile = to_string(9000000000LL + customer);
+        string title = titles[rng() % 8], timing = timings[rng() % 5];
+        stringBytes += 4 * sizeof(string) + heapBytes(name) + heapBytes(mobile) + heapBytes(title) + heapBytes(timing);
+        tickets.push_back(Ticket(name, PhoneKey(mobile), title, timing, {1}, 10.0));
+    }
+
+    double before = double(stringBytes) / ticketCount;
+    double after = double(3 * sizeof(Symbol) + sizeof(PhoneKey)) + double(symbols.memoryUsage()) / ticketCount;
+    cout << ticketCount << " tickets, " << symbols.size() << " distinct strings\n"
+         << fixed << setprecision(1)
+         << "name/mobile/title/timing as strings: " << before << " bytes per ticket\n"
+         << "name/title/timing as symbols, mobile as PhoneKey: " << after << " bytes per ticket (ids + share of symbol table)\n";
+    return 0;
+}
+
+// Heap allocations made so far, counted by the replacement operator new below
+// in builds with -DCOUNT_ALLOCATIONS and always 0 otherwise, so normal builds
+// keep the library allocator
+static atomic<size_t> heapAllocations(0);
+
+#ifdef COUNT_ALLOCATIONS
+// Kept out of line: inlined into library code, GCC sees malloc() paired with
+// operator delete and warns about a mismatch that is not there
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { free(p); }
+#endif
+
+// Allocation check (run with --alloc in a -DCOUNT_ALLOCATIONS build): books and cancels through the string
+// API, as the console does, and through the id API, counting heap allocations
+// per booking. The id API must not allocate once the ticket store is warm.
+int runAllocationCheck()
+{
+#ifndef COUNT_ALLOCATIONS
+    cout << "Allocations are only counted in a build with -DCOUNT_ALLOCATIONS\n";
+    return 1;
+#endif
+    const int customerCount = 1000, rounds = 5;
+    BookingSystem system;
+    system.addMovie("The Shawshank Redemption", "7:00 PM", 10.0, customerCount);
+
+    vector<string> names;
+    vector<PhoneKey> mobiles;
+    for (int i = 0; i < customerCount; i++)
+    {
+        names.push_back("Customer Number " + to_string(i)); // Too long to fit inline in a string
+        mobiles.push_back(PhoneKey(to_string(9000000000LL + i)));
+    }
+    string_view title = "The Shawshank Redemption", timing = "7:00 PM";
+
+    // String API, with the caller holding its text as views
+    streambuf *console = cout.rdbuf(nullptr); // The string API reports to the console
+    size_t before = heapAllocations.load();
+    for (int i = 0; i < customerCount; i++)
+    {
+        system.bookTicket(string(names[i]), mobiles[i], string(title), string(timing), {i + 1});
+        system.cancelTicket(string(names[i]), mobiles[i], string(title), {i + 1});
+    }
+    double stringApi = double(heapAllocations.load() - before) / customerCount;
+    cout.rdbuf(console);
+    cout.clear();
+
+    // Id API: resolve everything once, then warm up the ticket store
+    int show = system.findShow(title, timing);
+    vector<Symbol> customers;
+    for (const string &name : names)
+        customers.push_back(symbols.intern(name));
+    vector<vector<int>> seats;
+    for (int i = 0; i < customerCount; i++)
+        seats.push_back({i + 1});
+    vector<TicketSlotMap::Handle> handles(customerCount);
+    for (int i = 0; i < customerCount; i++)
+        handles[i] = system.book(customers[i], mobiles[i], show, seats[i]);
+    for (int i = 0; i < customerCount; i++)
+        system.cancel(handles[i], seats[i]);
+
+    before = heapAllocations.load();
+    bool ok = true;
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int i = 0; i < customerCount; i++)
+        {
+            handles[i] = system.book(customers[i], mobiles[i], show, seats[i]);
+            ok = ok && handles[i] != TicketSlotMap::none;
+        }
+        for (int i = 0; i < customerCount; i++)
+            ok = ok && system.cancel(handles[i], seats[i]);
+    }
+    size_t idApi = heapAllocations.load() - before;
+
+    cout << fixed << setprecision(2)
+         << "string API: " << stringApi << " allocations per booking\n"
+         << "id API:     " << double(idApi) / (customerCount * rounds) << " allocations per booking\n";
+    return (ok && idApi == 0) ? 0 : 1;
+}
+
+// Seat set regression check (run with --seat-check): INT32_MAX marks the empty
+// inline slots, so it must never be found on, or cancelled from, a ticket that
+// does not hold it
+int runSeatSetCheck()
+{
+    const int marker = INT32_MAX;
+    bool ok = true;
+    auto expect = [&ok](bool condition, const char *what)
+    {
+        if (!condition)
+        {
+            cout << "FAILED: " << what << "\n";
+            ok = false;
+        }
+    };
+
+    SeatSet seats;
+    seats.insert(1);
+    seats.insert(2);
+    seats.insert(3);
+    expect(!seats.contains(marker), "a 3 seat set contains INT32_MAX");
+    expect(!seats.erase(marker) && seats.size() == 3 && seats.contains(3), "erasing INT32_MAX drops a real seat");
+    expect(seats.insert(marker) && seats.contains(marker) && seats.erase(marker) && seats.size() == 3,
+           "INT32_MAX cannot be held as a real seat");
+    expect(!seats.insert(0) && !seats.insert(-1) && seats.size() == 3, "a set takes a seat below 1");
+    for (int seat = 4; seat <= 9; seat++)
+        seats.insert(seat); // Spills to the bitmap
+    expect(!seats.contains(marker) && !seats.erase(marker) && seats.size() == 9, "a spilled set contains INT32_MAX");
+    expect(!seats.insert(0) && !seats.insert(-1000000) && seats.size() == 9, "a spilled set takes a seat below 1");
+
+    BookingSystem system;
+    system.addMovie("Avengers", "10:00 AM", 10.0);
+    Movie *movie = system.getMovie("Avengers", "10:00 AM");
+    TicketSlotMap::Handle ticket = system.book(symbols.intern("Ann"), PhoneKey("9876543210"), system.findShow("Avengers", "10:00 AM"), {1, 2, 3});
+    expect(!system.cancel(ticket, {marker}), "cancelling seat 2147483647 succeeds");
+    expect(system.ticket(ticket)->bookedSeats.size() == 3 && !movie->seats.isFree(3), "cancelling seat 2147483647 changes the ticket");
+
+    cout << (ok ? "Seat set check passed\n" : "Seat set check failed\n");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--stress")
+    {
+        return runBookingStressTest();
+    }
+    if (argc > 1 && string(argv[1]) == "--memory")
+    {
+        return runMemoryReport();
+    }
+    if (argc > 1 && string(argv[1]) == "--seat-check")
+    {
+        return runSeatSetCheck();
+    }
+    if (argc > 1 && string(argv[1]) == "--alloc")
+    {
+        return runAllocationCheck();
+    }
+
     BookingSystem system;
     system.addMovie("Avengers", "10:00 AM", 10.0);
     system.addMovie("Inception", "1:00 PM", 12.0);
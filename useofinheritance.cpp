@@ -1,78 +1,666 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <iomanip>
 #include <algorithm>
-#include <set>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <numeric>
+#include <cmath>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
-class Movie
+// Seat geometry of one hall, shared by every show that plays in it. The hall is
+// a grid of rows and columns; positions that are aisles or gaps hold no seat.
+// Seats are numbered 1..seatCount() row by row, skipping the gaps, and every
+// row of the plane starts on a new 64-bit word.
+class HallLayout
 {
+private:
+    string hallName;
+    int rows, columns;
+    size_t wordsPerRow;
+    vector<uint64_t> seatPlane;    // One bit per grid position, set where there is a seat
+    vector<uint32_t> seatPosition; // Seat number - 1 -> bit position in the plane
+    vector<int> rowFirstSeat;      // Number of the first seat in each row
+
 public:
-    string title, timing;
-    double pricePerSeat;
-    vector<bool> seats;
+    // Builds a hall from one pattern per row: 'S' is a seat, anything else a gap
+    HallLayout(const string &name, const vector<string> &rowPatterns)
+        : hallName(name), rows(rowPatterns.size()), columns(0)
+    {
+        for (const string &pattern : rowPatterns)
+        {
+            columns = max(columns, (int)pattern.size());
+        }
+        wordsPerRow = (columns + 63) / 64;
+        seatPlane.assign(max<size_t>(1, rows * wordsPerRow), 0);
+        for (int r = 0; r < rows; r++)
+        {
+            rowFirstSeat.push_back(seatPosition.size() + 1);
+            for (int c = 0; c < (int)rowPatterns[r].size(); c++)
+            {
+                if (rowPatterns[r][c] == 'S')
+                {
+                    uint32_t position = r * wordsPerRow * 64 + c;
+                    seatPlane[position >> 6] |= 1ULL << (position & 63);
+                    seatPosition.push_back(position);
+                }
+            }
+        }
+    }
 
-    Movie(string t, string time, double p) : title(t), timing(time), pricePerSeat(p)
+    // A rectangular hall, with an aisle column after every `blockWidth` seats (0 = no aisles)
+    static shared_ptr<HallLayout> grid(const string &name, int rowCount, int seatsPerRow, int blockWidth = 0)
     {
-        seats.resize(50, true);
+        string pattern;
+        for (int seat = 0; seat < seatsPerRow; seat++)
+        {
+            if (blockWidth > 0 && seat > 0 && seat % blockWidth == 0)
+                pattern += '.';
+            pattern += 'S';
+        }
+        return make_shared<HallLayout>(name, vector<string>(rowCount, pattern));
     }
 
-    virtual void display() const
+    const string &name() const { return hallName; }
+    int rowCount() const { return rows; }
+    int columnCount() const { return columns; }
+    size_t rowWords() const { return wordsPerRow; }
+    size_t planeWords() const { return seatPlane.size(); }
+    const uint64_t *plane() const { return seatPlane.data(); }
+    int seatCount() const { return seatPosition.size(); }
+
+    bool validSeat(int seat) const
     {
-        cout << "Title: " << title << ", Timing: " << timing << ", Price: $"
-             << fixed << setprecision(2) << pricePerSeat << endl;
+        return seat >= 1 && seat <= seatCount();
     }
 
-    void showAvailableSeats() const
+    // Bit position of a seat in the plane; the seat must be valid
+    uint32_t position(int seat) const
     {
-        cout << "Available seats: ";
-        for (int i = 0; i < seats.size(); i++)
+        return seatPosition[seat - 1];
+    }
+
+    // Seat number at a bit position that holds a seat
+    int seatAt(uint32_t position) const
+    {
+        int row = position / (wordsPerRow * 64);
+        size_t word = position >> 6;
+        int seat = rowFirstSeat[row];
+        for (size_t w = row * wordsPerRow; w < word; w++)
         {
-            if (seats[i])
-                cout << i + 1 << " ";
+            seat += __builtin_popcountll(seatPlane[w]);
         }
-        cout << endl;
+        return seat + __builtin_popcountll(seatPlane[word] & ((1ULL << (position & 63)) - 1));
     }
+};
+
+// A block of adjacent free seats in one row, as returned by findBestSeats
+struct SeatBlock
+{
+    int firstSeat; // Seat number of the left-most seat
+    int count;
+    int row; // 0 = row nearest the screen
+    long long score; // Squared distance from the centre of the hall, lower is better
+};
 
-    void bookSeats(const vector<int> &seatNumbers)
+// Seat map of one show that many threads can book from at once. One bit per
+// position of the hall's plane (set = free seat) in 64-bit atomic words; gaps
+// are never set. A booking claims all of its seats with compare-and-swap, one
+// word at a time, and rolls back if any seat is gone.
+class AtomicSeatMap
+{
+private:
+    shared_ptr<const HallLayout> layout;
+    unique_ptr<atomic<uint64_t>[]> words;
+    int rows, seatsPerRow; // Grid rows and columns of the hall
+    size_t wordsPerRow;
+
+    size_t wordOf(int seat) const
+    {
+        return layout->position(seat) >> 6;
+    }
+
+    uint64_t bitOf(int seat) const
+    {
+        return 1ULL << (layout->position(seat) & 63);
+    }
+
+    // Groups seat numbers into (word index, bit mask) pairs, in word order
+    bool buildMasks(const vector<int> &seatNumbers, vector<pair<size_t, uint64_t>> &masks) const
     {
         for (int seat : seatNumbers)
         {
-            seats[seat - 1] = false;
+            if (!layout->validSeat(seat))
+                return false;
+            masks.push_back({wordOf(seat), bitOf(seat)});
+        }
+        sort(masks.begin(), masks.end());
+        size_t out = 0;
+        for (size_t i = 0; i < masks.size(); i++)
+        {
+            if (out > 0 && masks[out - 1].first == masks[i].first)
+                masks[out - 1].second |= masks[i].second;
+            else
+                masks[out++] = masks[i];
         }
+        masks.resize(out);
+        return true;
     }
 
-    void cancelSeats(const vector<int> &seatNumbers)
+    // Bits where a run of `count` set bits starts (bit i set = bits i..i+count-1 all set)
+    static uint64_t runStarts(uint64_t free, int count)
     {
-        cout << "Cancelling seats: ";
-        for (int seat : seatNumbers)
+        for (int have = 1; have < count && free;)
+        {
+            int step = min(have, count - have);
+            free &= free >> step;
+            have += step;
+        }
+        return free;
+    }
+
+    // Start column of the run closest to `target`, or -1 if there is none
+    static int nearestStart(uint64_t starts, int target)
+    {
+        uint64_t right = target < 64 ? starts & (~0ULL << target) : 0;
+        uint64_t left = starts & ~(~0ULL << target);
+        int best = -1;
+        if (right)
+            best = __builtin_ctzll(right);
+        if (left)
         {
-            if (!seats[seat - 1])
+            int candidate = 63 - __builtin_clzll(left);
+            if (best < 0 || target - candidate < best - target)
+                best = candidate;
+        }
+        return best;
+    }
+
+    // Scalar fallback for rows longer than one word: finds the run nearest the
+    // centre by walking the free runs of the row
+    int bestStartInLongRow(int row, int count, int target) const
+    {
+        int best = -1, bestDistance = 0, runStart = -1;
+        for (int col = 0; col <= seatsPerRow; col++)
+        {
+            bool free = col < seatsPerRow &&
+                        ((words[row * wordsPerRow + col / 64].load(memory_order_relaxed) >> (col % 64)) & 1ULL);
+            if (free && runStart < 0)
+                runStart = col;
+            if (!free && runStart >= 0)
             {
-                seats[seat - 1] = true;
-                cout << seat << " ";
+                // Any start in [runStart, col - count] fits; clamp the target into it
+                int last = col - count;
+                if (last >= runStart)
+                {
+                    // Scored by the exact centre distance: target is rounded down, so
+                    // comparing against it would favour the left side on a tie
+                    int start = max(runStart, min(target, last));
+                    int distance = abs(2 * start + count - 1 - (seatsPerRow - 1));
+                    if (best < 0 || distance < bestDistance)
+                    {
+                        best = start;
+                        bestDistance = distance;
+                    }
+                }
+                runStart = -1;
+            }
+        }
+        return best;
+    }
+
+    void addCandidate(vector<SeatBlock> &result, int row, int start, int count, int maxResults) const
+    {
+        long long dc = 2LL * start + count - 1 - (seatsPerRow - 1);
+        long long dr = 2LL * row - (rows - 1);
+        SeatBlock block = {layout->seatAt(row * wordsPerRow * 64 + start), count, row, dc * dc + dr * dr};
+        auto pos = upper_bound(result.begin(), result.end(), block, [](const SeatBlock &x, const SeatBlock &y)
+                               { return x.score < y.score; });
+        if (pos - result.begin() < maxResults)
+        {
+            result.insert(pos, block);
+            if ((int)result.size() > maxResults)
+                result.pop_back();
+        }
+    }
+
+public:
+    AtomicSeatMap(shared_ptr<const HallLayout> hall)
+        : layout(hall), words(new atomic<uint64_t>[hall->planeWords()]),
+          rows(hall->rowCount()), seatsPerRow(hall->columnCount()), wordsPerRow(hall->rowWords())
+    {
+        // Every seat starts free; gaps stay clear forever
+        for (size_t w = 0; w < layout->planeWords(); w++)
+        {
+            words[w].store(layout->plane()[w], memory_order_relaxed);
+        }
+    }
+
+    const HallLayout &hall() const { return *layout; }
+
+    int size() const { return layout->seatCount(); }
+
+    bool isFree(int seat) const
+    {
+        return words[wordOf(seat)].load(memory_order_acquire) & bitOf(seat);
+    }
+
+    // Claims every seat in seatNumbers, or none of them
+    bool claimAll(const vector<int> &seatNumbers)
+    {
+        static thread_local vector<pair<size_t, uint64_t>> masks; // Reused so booking does not allocate
+        masks.clear();
+        if (!buildMasks(seatNumbers, masks))
+            return false;
+
+        for (size_t i = 0; i < masks.size(); i++)
+        {
+            atomic<uint64_t> &word = words[masks[i].first];
+            uint64_t mask = masks[i].second;
+            uint64_t current = word.load(memory_order_relaxed);
+            do
+            {
+                if ((current & mask) != mask)
+                {
+                    // Someone else holds one of these seats: give back what we took
+                    for (size_t j = 0; j < i; j++)
+                    {
+                        words[masks[j].first].fetch_or(masks[j].second, memory_order_release);
+                    }
+                    return false;
+                }
+            } while (!word.compare_exchange_weak(current, current & ~mask, memory_order_acq_rel, memory_order_relaxed));
+        }
+        return true;
+    }
+
+    // Frees one seat, returns false if it was not booked
+    bool release(int seat)
+    {
+        if (!layout->validSeat(seat))
+            return false;
+        return !(words[wordOf(seat)].fetch_or(bitOf(seat), memory_order_acq_rel) & bitOf(seat));
+    }
+
+    // Finds blocks of `count` adjacent free seats (never across an aisle), at most
+    // one per row, best (closest to the centre of the hall) first. This reads a snapshot; the
+    // seats still have to be claimed with claimAll.
+    vector<SeatBlock> findBestSeats(int count, int maxResults = 3) const
+    {
+        vector<SeatBlock> result;
+        if (count < 1 || count > seatsPerRow || maxResults < 1)
+            return result;
+        result.reserve(maxResults + 1);
+        int target = (seatsPerRow - count) / 2; // Start column that centres the block
+
+        if (wordsPerRow > 1)
+        {
+            for (int r = 0; r < rows; r++)
+            {
+                int start = bestStartInLongRow(r, count, target);
+                if (start >= 0)
+                    addCandidate(result, r, start, count, maxResults);
             }
+            return result;
+        }
+
+        int r = 0;
+#ifdef __AVX2__
+        // Four one-word rows per step: the shift-and run search runs lane by lane
+        for (; r + 4 <= rows; r += 4)
+        {
+            __m256i v = _mm256_set_epi64x(words[r + 3].load(memory_order_relaxed), words[r + 2].load(memory_order_relaxed),
+                                          words[r + 1].load(memory_order_relaxed), words[r].load(memory_order_relaxed));
+            for (int have = 1; have < count;)
+            {
+                int step = min(have, count - have);
+                v = _mm256_and_si256(v, _mm256_srl_epi64(v, _mm_cvtsi32_si128(step)));
+                have += step;
+            }
+            alignas(32) uint64_t starts[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(starts), v);
+            for (int lane = 0; lane < 4; lane++)
+            {
+                if (starts[lane])
+                    addCandidate(result, r + lane, nearestStart(starts[lane], target), count, maxResults);
+            }
+        }
+#endif
+        for (; r < rows; r++)
+        {
+            uint64_t starts = runStarts(words[r].load(memory_order_relaxed), count);
+            if (starts)
+                addCandidate(result, r, nearestStart(starts, target), count, maxResults);
+        }
+        return result;
+    }
+};
+
+// Spreads the bits of an integer key for open-addressing tables (splitmix64 finaliser)
+inline size_t mixHash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    return key ^ (key >> 33);
+}
+
+// Id of a string in the global symbol table
+typedef uint32_t Symbol;
+
+// Global symbol table: every distinct title, timing and customer name is
+// stored once and referred to by a 32-bit id, so comparing two of them
+// is an integer compare. Lookups of known strings go through an open-addressing
+// table and never allocate.
+class SymbolTable
+{
+private:
+    vector<string> strings;
+    vector<Symbol> slots; // Symbol + 1, 0 = empty; size is a power of two
+    size_t textBytes = 0;
+
+    static uint64_t hashOf(string_view s)
+    {
+        uint64_t h = 14695981039346656037ULL; // FNV-1a
+        for (unsigned char c : s)
+        {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // Slot holding s, or the empty slot where it would go
+    size_t probe(string_view s) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = hashOf(s) & mask;
+        while (slots[i] != 0 && strings[slots[i] - 1] != s)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        slots.assign(max<size_t>(16, slots.size() * 2), 0);
+        for (size_t id = 0; id < strings.size(); id++)
+        {
+            slots[probe(strings[id])] = id + 1;
+        }
+    }
+
+public:
+    static const Symbol none = ~0u;
+
+    // Id of s, or none if it was never interned
+    Symbol find(string_view s) const
+    {
+        if (slots.empty())
+            return none;
+        return slots[probe(s)] - 1;
+    }
+
+    Symbol intern(string_view s)
+    {
+        if ((strings.size() + 1) * 2 > slots.size())
+            grow();
+        size_t i = probe(s);
+        if (slots[i] == 0)
+        {
+            strings.emplace_back(s);
+            slots[i] = strings.size();
+            textBytes += strings.back().capacity() > 15 ? strings.back().capacity() + 1 : 0; // Heap part, beyond the inline buffer
+        }
+        return slots[i] - 1;
+    }
+
+    const string &str(Symbol id) const { return strings[id]; }
+
+    size_t size() const { return strings.size(); }
+
+    // Bytes held by the table: the strings, their text and the hash slots
+    size_t memoryUsage() const
+    {
+        return strings.capacity() * sizeof(string) + textBytes + slots.capacity() * sizeof(Symbol);
+    }
+};
+
+SymbolTable symbols;
+
+// A 10 digit mobile number packed into an integer. Validation and packing
+// run on 8 digits at a time inside a 64-bit word (SWAR), so checking a
+// number is a few arithmetic ops with no per-character branches. Assumes a
+// little-endian target.
+class PhoneKey
+{
+private:
+    uint64_t value;
+
+    // True if all 8 bytes of chunk are ASCII digits
+    static bool eightDigits(uint64_t chunk)
+    {
+        return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+                (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+    }
+
+    // The 8 digits in chunk as a number, first character most significant
+    static uint32_t eightDigitValue(uint64_t chunk)
+    {
+        chunk = (chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+        chunk = (chunk & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+        return uint32_t((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+    }
+
+public:
+    static const uint64_t invalid = ~0ULL;
+
+    PhoneKey() : value(invalid) {}
+    explicit PhoneKey(string_view mobile) : value(parse(mobile.data(), mobile.size())) {}
+
+    // The number in text[0..length), or invalid unless it is exactly 10 digits
+    static uint64_t parse(const char *text, size_t length)
+    {
+        if (length != 10)
+            return invalid;
+        uint64_t chunk;
+        memcpy(&chunk, text, 8);
+        unsigned d8 = (unsigned char)text[8] - '0', d9 = (unsigned char)text[9] - '0';
+        if (!eightDigits(chunk) || d8 > 9 || d9 > 9)
+            return invalid;
+        return uint64_t(eightDigitValue(chunk)) * 100 + d8 * 10 + d9;
+    }
+
+    bool valid() const { return value != invalid; }
+    uint64_t packed() const { return value; }
+
+    // Back to the 10 digit text, keeping leading zeros
+    string str() const
+    {
+        if (!valid())
+            return "";
+        string text(10, '0');
+        uint64_t rest = value;
+        for (int i = 9; i >= 0; i--)
+        {
+            text[i] = '0' + rest % 10;
+            rest /= 10;
+        }
+        return text;
+    }
+
+    bool operator==(const PhoneKey &other) const { return value == other.value; }
+    bool operator!=(const PhoneKey &other) const { return value != other.value; }
+};
+
+// Heap allocations made so far, counted by the replacement operator new below
+// in builds with -DCOUNT_ALLOCATIONS and always 0 otherwise, so normal builds
+// keep the library allocator
+static atomic<size_t> heapAllocations(0);
+
+#ifdef COUNT_ALLOCATIONS
+// Kept out of line: inlined into library code, GCC sees malloc() paired with
+// operator delete and warns about a mismatch that is not there
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { free(p); }
+#endif
+
+// Pool for one class hierarchy. Every slot fits the largest of the derived
+// types, slots come in chunks of 64 that never move, so pointers handed out
+// stay valid until destroy(), and freed slots are reused through a free list.
+// Objects of the hierarchy sit next to each other instead of between
+// unrelated heap blocks, and a chunk costs one allocation per 64 objects.
+template <typename Base, typename... Derived>
+class ObjectPool
+{
+private:
+    static constexpr size_t slotSize = max({sizeof(Derived)...});
+    static constexpr size_t slotAlign = max({alignof(Derived)...});
+    static const size_t chunkSlots = 64;
+
+    union Slot
+    {
+        Slot *next;
+        alignas(slotAlign) unsigned char storage[slotSize];
+    };
+
+    vector<unique_ptr<Slot[]>> chunks;
+    Slot *freeList = nullptr;
+    size_t live = 0;
+
+    void addChunk()
+    {
+        chunks.emplace_back(new Slot[chunkSlots]);
+        Slot *chunk = chunks.back().get();
+        for (size_t i = chunkSlots; i-- > 0;)
+        {
+            chunk[i].next = freeList; // Hand the slots out in address order
+            freeList = &chunk[i];
+        }
+    }
+
+public:
+    static_assert(has_virtual_destructor<Base>::value, "destroy() goes through Base's destructor");
+
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        static_assert(is_base_of<Base, T>::value && sizeof(T) <= slotSize && alignof(T) <= slotAlign,
+                      "T must be one of the pool's types");
+        if (!freeList)
+            addChunk();
+        Slot *slot = freeList;
+        freeList = slot->next; // Read before the object overwrites it
+        T *object;
+        try
+        {
+            object = new (slot->storage) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            slot->next = freeList;
+            freeList = slot;
+            throw;
+        }
+        live++;
+        return object;
+    }
+
+    void destroy(Base *object)
+    {
+        Slot *slot = static_cast<Slot *>(dynamic_cast<void *>(object)); // Start of the most derived object
+        object->~Base();
+        slot->next = freeList;
+        freeList = slot;
+        live--;
+    }
+
+    size_t size() const { return live; }
+    size_t chunkCount() const { return chunks.size(); }
+};
+
+class Movie
+{
+public:
+    Symbol title, timing;
+    double pricePerSeat;
+    AtomicSeatMap seats;
+
+    Movie(const string &t, const string &time, double p, shared_ptr<const HallLayout> hall)
+        : title(symbols.intern(t)), timing(symbols.intern(time)), pricePerSeat(p), seats(hall) {}
+
+    virtual ~Movie() {}
+
+    // Factor applied to the base price of a seat
+    virtual double priceMultiplier() const { return 1.0; }
+
+    virtual void display(ostream &out = cout) const
+    {
+        out << "Title: " << symbols.str(title) << ", Timing: " << symbols.str(timing) << ", Hall: " << seats.hall().name()
+            << ", Price: $" << fixed << setprecision(2) << pricePerSeat << endl;
+    }
+
+    void showAvailableSeats() const
+    {
+        cout << "Available seats: ";
+        for (int i = 1; i <= seats.size(); i++)
+        {
+            if (seats.isFree(i))
+                cout << i << " ";
         }
         cout << endl;
     }
 
-    bool checkBookSeats(const vector<int> &seatNumbers) const
+    // Books all the seats or none of them; safe to call from several threads
+    bool bookSeats(const vector<int> &seatNumbers)
     {
+        return seats.claimAll(seatNumbers);
+    }
+
+    void cancelSeats(const vector<int> &seatNumbers)
+    {
+        cout << "Cancelling seats: ";
         for (int seat : seatNumbers)
         {
-            if (!seats[seat - 1])
-                return false;
+            if (seats.release(seat))
+            {
+                cout << seat << " ";
+            }
         }
-        return true;
+        cout << endl;
     }
 
     bool validSeat(const vector<int> &seatNumbers)
     {
         for (int seat : seatNumbers)
         {
-            if (seat < 1 || seat > 50)
+            if (!seats.hall().validSeat(seat))
                 return true;
         }
         return false;
@@ -82,126 +670,636 @@ public:
 class RegularMovie : public Movie
 {
 public:
-    RegularMovie(string t, string time, double p) : Movie(t, time, p) {}
+    RegularMovie(const string &t, const string &time, double p, shared_ptr<const HallLayout> hall) : Movie(t, time, p, hall) {}
 };
 
 class PremiumMovie : public Movie
 {
 public:
-    PremiumMovie(string t, string time, double p) : Movie(t, time, p)
+    PremiumMovie(const string &t, const string &time, double p, shared_ptr<const HallLayout> hall) : Movie(t, time, p, hall)
+    {
+        pricePerSeat *= priceMultiplier();
+    }
+
+    double priceMultiplier() const override { return 1.5; }
+
+    void display(ostream &out = cout) const override
+    {
+        out << "***** Premium Movie *****" << endl;
+        Movie::display(out);
+    }
+};
+
+// Seats held by one ticket. Up to 8 seats live sorted in an inline array,
+// with unused slots set to a sentinel, so a lookup compares all 8 slots
+// without branching. A ticket with more seats spills to a bitmap indexed by
+// seat number, which never grows past the hall it was booked in. Neither
+// form allocates per seat.
+class SeatSet
+{
+private:
+    static const int inlineCapacity = 8;
+    static const int unused = INT32_MAX; // Sorts after every real seat
+
+    int count = 0;
+    int small[inlineCapacity] = {unused, unused, unused, unused, unused, unused, unused, unused};
+    vector<uint64_t> words; // Non-empty once spilled; bit s is seat s
+
+    bool spilled() const { return !words.empty(); }
+
+    bool bitmapHas(int seat) const
+    {
+        size_t w = size_t(seat) >> 6;
+        return seat >= 0 && w < words.size() && (words[w] >> (seat & 63) & 1);
+    }
+
+    void spill(int seat)
+    {
+        words.assign(size_t(max(seat, small[count - 1])) / 64 + 1, 0);
+        for (int i = 0; i < count; i++)
+        {
+            words[size_t(small[i]) >> 6] |= 1ULL << (small[i] & 63);
+            small[i] = unused;
+        }
+    }
+
+    // First seat at or after `seat`, or the end position
+    int nextSeat(int seat) const
+    {
+        size_t w = size_t(seat) >> 6;
+        if (w >= words.size())
+            return int(words.size() * 64);
+        uint64_t word = words[w] & (~0ULL << (seat & 63));
+        while (word == 0)
+        {
+            if (++w == words.size())
+                return int(words.size() * 64);
+            word = words[w];
+        }
+        return int(w * 64) + __builtin_ctzll(word);
+    }
+
+public:
+    class const_iterator
+    {
+    private:
+        const SeatSet *seats;
+        int position; // Slot while inline, seat number once spilled
+
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef int reference;
+
+        const_iterator(const SeatSet *s, int p) : seats(s), position(p) {}
+        int operator*() const { return seats->spilled() ? position : seats->small[position]; }
+        const_iterator &operator++()
+        {
+            position = seats->spilled() ? seats->nextSeat(position + 1) : position + 1;
+            return *this;
+        }
+        bool operator!=(const const_iterator &other) const { return position != other.position; }
+        bool operator==(const const_iterator &other) const { return position == other.position; }
+    };
+
+    SeatSet() {}
+
+    template <typename It>
+    SeatSet(It first, It last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    bool contains(int seat) const
+    {
+        if (spilled())
+            return bitmapHas(seat);
+        bool hit = false;
+        for (int i = 0; i < inlineCapacity; i++)
+            hit |= (small[i] == seat) & (i < count); // Empty slots hold `unused`, which is also a valid int
+        return hit;
+    }
+
+    // True if every seat in the range is in the set
+    template <typename Range>
+    bool containsAll(const Range &seatNumbers) const
+    {
+        bool all = true;
+        for (int seat : seatNumbers)
+            all &= contains(seat);
+        return all;
+    }
+
+    // Adds a seat; false if it was already there or is not a seat number (< 1)
+    bool insert(int seat)
+    {
+        if (seat < 1 || contains(seat))
+            return false;
+        if (!spilled() && count == inlineCapacity)
+            spill(seat);
+        if (spilled())
+        {
+            if (size_t(seat) / 64 >= words.size())
+                words.resize(size_t(seat) / 64 + 1, 0);
+            words[size_t(seat) >> 6] |= 1ULL << (seat & 63);
+        }
+        else
+        {
+            int i = count;
+            while (i > 0 && small[i - 1] > seat) // Insertion sort keeps the slots ordered
+            {
+                small[i] = small[i - 1];
+                i--;
+            }
+            small[i] = seat;
+        }
+        count++;
+        return true;
+    }
+
+    template <typename It>
+    void insert(It first, It last)
     {
-        pricePerSeat *= 1.5;
+        for (; first != last; ++first)
+            insert(*first);
     }
 
-    void display() const override
+    // Removes a seat; false if it was not there
+    bool erase(int seat)
     {
-        cout << "***** Premium Movie *****" << endl;
-        Movie::display();
+        if (!contains(seat))
+            return false;
+        if (spilled())
+        {
+            words[size_t(seat) >> 6] &= ~(1ULL << (seat & 63));
+        }
+        else
+        {
+            int i = 0;
+            while (small[i] != seat)
+                i++;
+            for (; i < count - 1; i++)
+                small[i] = small[i + 1];
+            small[count - 1] = unused;
+        }
+        count--;
+        return true;
     }
+
+    const_iterator begin() const { return const_iterator(this, spilled() ? nextSeat(0) : 0); }
+    const_iterator end() const { return const_iterator(this, spilled() ? int(words.size() * 64) : count); }
 };
 
 class Ticket
 {
 public:
-    string customerName, mobileNumber, movieTitle, movieTiming;
-    set<int> bookedSeats;
+    Symbol customerName;
+    PhoneKey mobileNumber;
+    Symbol movieTitle, movieTiming;
+    SeatSet bookedSeats;
     double totalPrice;
 
-    Ticket(string name, string mobile, string title, string time, const vector<int> &seats, double pricePerSeat)
+    Ticket(Symbol name, PhoneKey mobile, Symbol title, Symbol time, const vector<int> &seats, double pricePerSeat)
         : customerName(name), mobileNumber(mobile), movieTitle(title), movieTiming(time)
     {
         bookedSeats.insert(seats.begin(), seats.end());
         totalPrice = bookedSeats.size() * pricePerSeat;
     }
 
-    virtual void display() const
+    Ticket(string_view name, PhoneKey mobile, string_view title, string_view time, const vector<int> &seats, double pricePerSeat)
+        : Ticket(symbols.intern(name), mobile, symbols.intern(title), symbols.intern(time), seats, pricePerSeat) {}
+
+    virtual ~Ticket() {}
+
+    // Factor applied to the movie's seat price
+    virtual double priceMultiplier() const { return 1.0; }
+
+    virtual void display(ostream &out = cout) const
+    {
+        out << "\n--- Ticket Details ---\nName: " << symbols.str(customerName) << "\nMobile: " << mobileNumber.str()
+            << "\nMovie: " << symbols.str(movieTitle) << "\nTiming: " << symbols.str(movieTiming) << "\nSeats: ";
+        for (int seat : bookedSeats)
+            out << seat << " ";
+        out << "\nTotal Price: $" << fixed << setprecision(2) << totalPrice << endl;
+    }
+
+    bool checkCancel(const vector<int> &seats) const
+    {
+        return bookedSeats.containsAll(seats);
+    }
+
+    void removeSeats(const vector<int> &seats, double pricePerSeat)
+    {
+        for (int seat : seats)
+        {
+            bookedSeats.erase(seat);
+        }
+        totalPrice = bookedSeats.size() * pricePerSeat * priceMultiplier();
+    }
+
+    bool allSeatsCancel(const vector<int> &seats) const
+    {
+        return bookedSeats.containsAll(seats);
+    }
+    bool isAllSeatsCancel(const vector<int> &seats) const
+    {
+        return checkCancel(seats) && seats.size() == bookedSeats.size();
+    }
+
+    bool addseat(const vector<int> &seatNumbers, double pricePerSeat)
+    {
+        bookedSeats.insert(seatNumbers.begin(), seatNumbers.end()); // Seats already held are skipped
+        totalPrice = bookedSeats.size() * pricePerSeat * priceMultiplier();
+        return true;
+    }
+};
+
+class StandardTicket : public Ticket
+{
+public:
+    using Ticket::Ticket;
+};
+
+class VIPTicket : public Ticket
+{
+public:
+    VIPTicket(Symbol name, PhoneKey mobile, Symbol title, Symbol time, const vector<int> &seats, double pricePerSeat)
+        : Ticket(name, mobile, title, time, seats, pricePerSeat)
+    {
+        totalPrice *= priceMultiplier();
+    }
+
+    VIPTicket(string_view name, PhoneKey mobile, string_view title, string_view time, const vector<int> &seats, double pricePerSeat)
+        : VIPTicket(symbols.intern(name), mobile, symbols.intern(title), symbols.intern(time), seats, pricePerSeat) {}
+
+    double priceMultiplier() const override { return 2.0; }
+
+    void display(ostream &out = cout) const override
+    {
+        out << "\n--- VIP Ticket Details ---\n";
+        Ticket::display(out);
+    }
+};
+
+// Which concrete class a row of a column store stands for
+enum class MovieKind : uint8_t
+{
+    Regular,
+    Premium
+};
+
+enum class TicketKind : uint8_t
+{
+    Standard,
+    VIP
+};
+
+// Devirtualised copy of a movie catalog for bulk work: one vector per field
+// plus a kind tag, so listing and repricing are plain loops with no virtual
+// calls. The PremiumMovie multiplier is a table indexed by the tag.
+class MovieColumns
+{
+public:
+    static constexpr double priceMultiplier[2] = {1.0, 1.5};
+
+    vector<MovieKind> kind;
+    vector<Symbol> title, timing, hallName;
+    vector<double> basePrice;
+
+    size_t size() const { return kind.size(); }
+
+    double price(size_t row) const { return basePrice[row] * priceMultiplier[size_t(kind[row])]; }
+
+    void add(const Movie &movie)
+    {
+        MovieKind k = dynamic_cast<const PremiumMovie *>(&movie) ? MovieKind::Premium : MovieKind::Regular;
+        kind.push_back(k);
+        title.push_back(movie.title);
+        timing.push_back(movie.timing);
+        hallName.push_back(symbols.intern(movie.seats.hall().name()));
+        basePrice.push_back(movie.pricePerSeat / priceMultiplier[size_t(k)]);
+    }
+
+    // Sets the base seat price of every show of a title
+    void reprice(Symbol movieTitle, double newBasePrice)
+    {
+        for (size_t row = 0; row < size(); row++)
+        {
+            if (title[row] == movieTitle)
+                basePrice[row] = newBasePrice;
+        }
+    }
+
+    // Same text as Movie::display and PremiumMovie::display, row by row
+    void list(ostream &out) const
+    {
+        out << fixed << setprecision(2);
+        for (size_t row = 0; row < size(); row++)
+        {
+            if (kind[row] == MovieKind::Premium)
+                out << "***** Premium Movie *****\n";
+            out << "Title: " << symbols.str(title[row]) << ", Timing: " << symbols.str(timing[row])
+                << ", Hall: " << symbols.str(hallName[row]) << ", Price: $" << price(row) << '\n';
+        }
+    }
+};
+
+// Devirtualised copy of the booked tickets. Seats of row i are
+// seats[seatBegin[i], seatBegin[i + 1]); the VIPTicket multiplier is a table
+// indexed by the tag, so revenue sums and repricing vectorise.
+class TicketColumns
+{
+public:
+    static constexpr double priceMultiplier[2] = {1.0, 2.0};
+
+    vector<TicketKind> kind;
+    vector<Symbol> customerName, movieTitle, movieTiming;
+    vector<PhoneKey> mobileNumber;
+    vector<uint32_t> seatBegin{0};
+    vector<int> seats;
+    vector<double> pricePerSeat, totalPrice;
+
+    size_t size() const { return kind.size(); }
+
+    void add(const Ticket &ticket)
+    {
+        TicketKind k = dynamic_cast<const VIPTicket *>(&ticket) ? TicketKind::VIP : TicketKind::Standard;
+        size_t seatCount = ticket.bookedSeats.size();
+        kind.push_back(k);
+        customerName.push_back(ticket.customerName);
+        movieTitle.push_back(ticket.movieTitle);
+        movieTiming.push_back(ticket.movieTiming);
+        mobileNumber.push_back(ticket.mobileNumber);
+        seats.insert(seats.end(), ticket.bookedSeats.begin(), ticket.bookedSeats.end());
+        seatBegin.push_back(seats.size());
+        pricePerSeat.push_back(seatCount ? ticket.totalPrice / (seatCount * priceMultiplier[size_t(k)]) : 0.0);
+        totalPrice.push_back(ticket.totalPrice);
+    }
+
+    // Four running sums, so the adds do not wait on each other
+    double revenue() const
+    {
+        double sum[4] = {0, 0, 0, 0};
+        size_t row = 0, n = totalPrice.size();
+        for (; row + 4 <= n; row += 4)
+        {
+            sum[0] += totalPrice[row];
+            sum[1] += totalPrice[row + 1];
+            sum[2] += totalPrice[row + 2];
+            sum[3] += totalPrice[row + 3];
+        }
+        for (; row < n; row++)
+            sum[0] += totalPrice[row];
+        return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    }
+
+    // New seat price for every ticket of a title, as if the movie had been repriced
+    void reprice(Symbol title, double newPricePerSeat)
+    {
+        for (size_t row = 0; row < size(); row++)
+        {
+            if (movieTitle[row] == title)
+            {
+                pricePerSeat[row] = newPricePerSeat;
+                totalPrice[row] = (seatBegin[row + 1] - seatBegin[row]) * newPricePerSeat * priceMultiplier[size_t(kind[row])];
+            }
+        }
+    }
+
+    // Same text as Ticket::display and VIPTicket::display, row by row
+    void list(ostream &out) const
+    {
+        out << fixed << setprecision(2);
+        for (size_t row = 0; row < size(); row++)
+        {
+            if (kind[row] == TicketKind::VIP)
+                out << "\n--- VIP Ticket Details ---\n";
+            out << "\n--- Ticket Details ---\nName: " << symbols.str(customerName[row]) << "\nMobile: " << mobileNumber[row].str()
+                << "\nMovie: " << symbols.str(movieTitle[row]) << "\nTiming: " << symbols.str(movieTiming[row]) << "\nSeats: ";
+            for (uint32_t i = seatBegin[row]; i < seatBegin[row + 1]; i++)
+                out << seats[i] << " ";
+            out << "\nTotal Price: $" << totalPrice[row] << '\n';
+        }
+    }
+};
+
+// Open-addressing index from a (title, timing) symbol pair to a movie's
+// position in the movies vector
+class ShowIndex
+{
+private:
+    struct Slot
+    {
+        uint64_t key;
+        int position; // -1 = empty
+    };
+
+    vector<Slot> slots; // Size is a power of two, at most half full
+    size_t used = 0;
+
+    static uint64_t keyOf(Symbol title, Symbol timing)
+    {
+        return (uint64_t(title) << 32) | timing;
+    }
+
+    size_t probe(uint64_t key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = mixHash(key) & mask;
+        while (slots[i].position >= 0 && slots[i].key != key)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        vector<Slot> old = slots;
+        slots.assign(max<size_t>(16, old.size() * 2), Slot{0, -1});
+        for (const Slot &slot : old)
+        {
+            if (slot.position >= 0)
+                slots[probe(slot.key)] = slot;
+        }
+    }
+
+public:
+    // Adds a show; the first movie added for a title and timing wins
+    void insert(Symbol title, Symbol timing, int position)
+    {
+        if ((used + 1) * 2 > slots.size())
+            grow();
+        uint64_t key = keyOf(title, timing);
+        size_t i = probe(key);
+        if (slots[i].position < 0)
+        {
+            slots[i] = Slot{key, position};
+            used++;
+        }
+    }
+
+    // Position of the movie, or -1 if there is no such show
+    int find(Symbol title, Symbol timing) const
+    {
+        if (title == SymbolTable::none || timing == SymbolTable::none || slots.empty())
+            return -1;
+        return slots[probe(keyOf(title, timing))].position;
+    }
+};
+
+// Secondary index from a customer's mobile number, as a PhoneKey, to the
+// positions of their tickets. Open addressing on the packed key; each customer
+// has only a few tickets, so lookup, insert and remove are O(1) amortised.
+class CustomerTicketIndex
+{
+private:
+    struct Slot
     {
-        cout << "\n--- Ticket Details ---\nName: " << customerName << "\nMobile: " << mobileNumber
-             << "\nMovie: " << movieTitle << "\nTiming: " << movieTiming << "\nSeats: ";
-        for (int seat : bookedSeats)
-            cout << seat << " ";
-        cout << "\nTotal Price: $" << fixed << setprecision(2) << totalPrice << endl;
-    }
+        uint64_t key;
+        int list; // Index into lists, -1 = empty slot
+    };
 
-    bool checkCancel(const vector<int> &seats) const
+    vector<Slot> slots; // Size is a power of two, at most half full
+    vector<vector<int>> lists;
+
+    size_t probe(uint64_t key) const
     {
-        for (int seat : seats)
+        size_t mask = slots.size() - 1;
+        size_t i = mixHash(key) & mask;
+        while (slots[i].list >= 0 && slots[i].key != key)
         {
-            if (bookedSeats.find(seat) == bookedSeats.end())
-                return false;
+            i = (i + 1) & mask;
         }
-        return true;
+        return i;
     }
 
-    void removeSeats(const vector<int> &seats, double pricePerSeat)
+    void grow()
     {
-        for (int seat : seats)
+        vector<Slot> old = slots;
+        slots.assign(max<size_t>(16, old.size() * 2), Slot{0, -1});
+        for (const Slot &slot : old)
         {
-            bookedSeats.erase(seat);
+            if (slot.list >= 0)
+                slots[probe(slot.key)] = slot;
         }
-        totalPrice = bookedSeats.size() * pricePerSeat;
     }
 
-    bool allSeatsCancel(const vector<int> &seats) const
+    vector<int> *listFor(uint64_t key)
     {
-        for (int seat : seats)
-        {
-            if (bookedSeats.find(seat) == bookedSeats.end())
-                return false;
-        }
-        return true;
+        if (slots.empty())
+            return nullptr;
+        size_t i = probe(key);
+        return slots[i].list >= 0 ? &lists[slots[i].list] : nullptr;
     }
-    bool isAllSeatsCancel(const vector<int> &seats) const
+
+public:
+    void insert(PhoneKey mobile, int ticket)
     {
-        return checkCancel(seats) && seats.size() == bookedSeats.size();
+        uint64_t key = mobile.packed();
+        if ((lists.size() + 1) * 2 > slots.size())
+            grow();
+        size_t i = probe(key);
+        if (slots[i].list < 0)
+        {
+            slots[i] = Slot{key, (int)lists.size()};
+            lists.emplace_back();
+        }
+        lists[slots[i].list].push_back(ticket);
     }
 
-    bool addseat(const vector<int> &seatNumbers, double pricePerSeat)
+    void remove(PhoneKey mobile, int ticket)
     {
-        for (int seat : seatNumbers)
+        vector<int> *list = listFor(mobile.packed());
+        if (!list)
+            return;
+        auto it = std::find(list->begin(), list->end(), ticket);
+        if (it != list->end())
         {
-            if (bookedSeats.find(seat) == bookedSeats.end())
-            {
-                bookedSeats.insert(seat);
-            }
+            *it = list->back();
+            list->pop_back();
         }
-        totalPrice = bookedSeats.size() * pricePerSeat;
-        return true;
     }
-};
-
-class StandardTicket : public Ticket
-{
-public:
-    StandardTicket(string name, string mobile, string title, string time, const vector<int> &seats, double pricePerSeat)
-        : Ticket(name, mobile, title, time, seats, pricePerSeat) {}
-};
 
-class VIPTicket : public Ticket
-{
-public:
-    VIPTicket(string name, string mobile, string title, string time, const vector<int> &seats, double pricePerSeat)
-        : Ticket(name, mobile, title, time, seats, pricePerSeat)
+    // Records that a ticket moved from one position to another
+    void move(PhoneKey mobile, int from, int to)
     {
-        totalPrice *= 2;
+        vector<int> *list = listFor(mobile.packed());
+        if (!list)
+            return;
+        auto it = std::find(list->begin(), list->end(), from);
+        if (it != list->end())
+            *it = to;
     }
 
-    void display() const override
+    // Positions of every ticket booked with this mobile number
+    const vector<int> &find(PhoneKey mobile) const
     {
-        cout << "\n--- VIP Ticket Details ---\n";
-        Ticket::display();
+        static const vector<int> none;
+        if (slots.empty())
+            return none;
+        size_t i = probe(mobile.packed());
+        return slots[i].list >= 0 ? lists[slots[i].list] : none;
     }
 };
 
 class BookingSystem
 {
-    vector<Movie *> movies;
-    vector<Ticket *> tickets;
+    ObjectPool<Movie, RegularMovie, PremiumMovie> moviePool;
+    ObjectPool<Ticket, StandardTicket, VIPTicket> ticketPool;
+    vector<Movie *> movies;   // Owned by moviePool
+    vector<Ticket *> tickets; // Owned by ticketPool
+    ShowIndex showIndex;             // (title, timing) -> position in movies
+    CustomerTicketIndex ticketIndex; // Mobile number -> positions in tickets
+
+    // Removes a ticket by moving the last one into its place
+    void removeTicket(Ticket *ticket)
+    {
+        PhoneKey mobile = ticket->mobileNumber;
+        int position = -1;
+        for (int candidate : ticketIndex.find(mobile))
+        {
+            if (tickets[candidate] == ticket)
+                position = candidate;
+        }
+        ticketIndex.remove(mobile, position);
+        int last = tickets.size() - 1;
+        if (position != last)
+        {
+            ticketIndex.move(tickets[last]->mobileNumber, last, position);
+            tickets[position] = tickets[last];
+        }
+        tickets.pop_back();
+        ticketPool.destroy(ticket);
+    }
 
 public:
-    void addMovie(Movie *movie)
+    BookingSystem() = default;
+    BookingSystem(const BookingSystem &) = delete;
+    BookingSystem &operator=(const BookingSystem &) = delete;
+
+    ~BookingSystem()
+    {
+        for (Ticket *ticket : tickets)
+            ticketPool.destroy(ticket);
+        for (Movie *movie : movies)
+            moviePool.destroy(movie);
+    }
+
+    // Builds a RegularMovie or PremiumMovie in the pool and lists it
+    template <typename MovieType, typename... Args>
+    Movie *addMovie(Args &&...args)
     {
+        Movie *movie = moviePool.create<MovieType>(std::forward<Args>(args)...);
         movies.push_back(movie);
+        showIndex.insert(movie->title, movie->timing, movies.size() - 1);
+        return movie;
     }
 
     void showMovies() const
@@ -214,12 +1312,15 @@ public:
 
     Movie *getMovie(const string &title, const string &time)
     {
-        for (auto &movie : movies)
-        {
-            if (movie->title == title && movie->timing == time)
-                return movie;
-        }
-        return nullptr;
+        return getMovie(symbols.find(title), symbols.find(time));
+    }
+
+    Movie *getMovie(Symbol title, Symbol time)
+    {
+        int position = showIndex.find(title, time);
+        if (position < 0)
+            return nullptr;
+        return movies[position];
     }
 
     void showAvailableSeats(const string &title, const string &time)
@@ -235,245 +1336,694 @@ public:
         }
     }
 
-    void bookTicket(string name, string mobile, string title, string time, const vector<int> &seats, bool isVIP = false)
+    // Programmatic API: names and shows are resolved to ids once, and booking or
+    // cancelling through the ids copies no strings. Tickets come from the pool, so
+    // once it and the ticket list have grown these calls make no heap allocations.
+
+    // Position of a show for book(), or -1
+    int findShow(string_view title, string_view time) const
+    {
+        return showIndex.find(symbols.find(title), symbols.find(time));
+    }
+
+    // Claims the seats and adds them to the customer's ticket for the show, making
+    // one if needed; nullptr if any seat is taken
+    Ticket *book(Symbol customer, PhoneKey mobile, int show, const vector<int> &seats, bool isVIP = false)
+    {
+        Movie *movie = movies[show];
+        if (!movie->bookSeats(seats)) // Claims the seats only if all are available
+            return nullptr;
+        Ticket *ticket = findTicket(customer, mobile, movie->title, movie->timing);
+        if (ticket)
+        {
+            ticket->addseat(seats, movie->pricePerSeat);
+            return ticket;
+        }
+        if (isVIP)
+            ticket = ticketPool.create<VIPTicket>(customer, mobile, movie->title, movie->timing, seats, movie->pricePerSeat);
+        else
+            ticket = ticketPool.create<StandardTicket>(customer, mobile, movie->title, movie->timing, seats, movie->pricePerSeat);
+        tickets.push_back(ticket);
+        ticketIndex.insert(mobile, tickets.size() - 1);
+        return ticket;
+    }
+
+    // Gives back some of a ticket's seats, freeing the ticket when none are left;
+    // false if a seat is not on the ticket
+    bool cancel(Ticket *ticket, const vector<int> &seats)
     {
-        Movie *movie = getMovie(title, time);
-        if (movie)
+        if (!ticket->checkCancel(seats))
+            return false;
+        Movie *movie = getMovie(ticket->movieTitle, ticket->movieTiming);
+        for (int seat : seats)
+            movie->seats.release(seat);
+        if (ticket->isAllSeatsCancel(seats))
+            removeTicket(ticket);
+        else
+            ticket->removeSeats(seats, movie->pricePerSeat);
+        return true;
+    }
+
+    void bookTicket(const string &name, PhoneKey mobile, const string &title, const string &time, const vector<int> &seats, bool isVIP = false)
+    {
+        int show = findShow(title, time);
+        if (show >= 0)
         {
-            if (movie->validSeat(seats))
+            if (movies[show]->validSeat(seats))
             {
                 cout << "Booking failed: Please enter a valid seat number.\n";
                 return;
             }
-            if (movie->checkBookSeats(seats))
+            bool existing = getTicket(name, mobile, title, time) != nullptr;
+            Ticket *ticket = book(symbols.intern(name), mobile, show, seats, isVIP);
+            if (ticket)
             {
-                Ticket *ticket = getTicket(name, mobile, title, time);
-                if (ticket)
-                {   
-                    ticket->addseat(seats, movie->pricePerSeat);
-                    movie->bookSeats(seats);
-                    else
-                    {
-                        movie->bookSeats(seats);
-                        if (isVIP)
-                        {
-                            ticket = new VIPTicket(name, mobile, title, time, seats, movie->pricePerSeat);
-                        }
-                        else
-                        {
-                            ticket = new StandardTicket(name, mobile, title, time, seats, movie->pricePerSeat);
-                        }
-                        tickets.push_back(ticket);
-                        cout << "Booking successful!\n";
-                    }
-                    ticket->display();
-                }
-                else
-                {
-                    cout << "Booking failed: Some seats are unavailable.\n";
-                }
+                if (!existing)
+                    cout << "Booking successful!\n";
+                ticket->display();
             }
             else
             {
-                cout << "Movie or timing not found.\n";
+                cout << "Booking failed: Some seats are unavailable.\n";
             }
         }
+        else
+        {
+            cout << "Movie or timing not found.\n";
+        }
+    }
 
-        void cancelTicket(string name, string mobile, string title, const vector<int> &seats, string time)
+    void cancelTicket(const string &name, PhoneKey mobile, const string &title, const vector<int> &seats, const string &time)
+    {
+        Ticket *ticket = getTicket(name, mobile, title, time);
+        if (ticket)
         {
-            Ticket *ticket = getTicket(name, mobile, title, time);
-            if (ticket)
+            Movie *movie = getMovie(ticket->movieTitle, ticket->movieTiming);
+            if (movie)
             {
-                Movie *movie = getMovie(title, ticket->movieTiming);
-                if (movie)
+                if (ticket->checkCancel(seats))
                 {
-                    if (ticket->checkCancel(seats))
+                    if (ticket->isAllSeatsCancel(seats))
                     {
-                        if (ticket->isAllSeatsCancel(seats))
-                        {
-                            tickets.erase(remove(tickets.begin(), tickets.end(), ticket), tickets.end());
-                            delete ticket;
-                            cout << "All seats canceled, ticket removed.\n";
-                        }
-                        else
-                        {
-
-                            movie->cancelSeats(seats);
-                            ticket->removeSeats(seats, movie->pricePerSeat);
-                            cout << "Seats canceled successfully.\n";
-                        }
+                        movie->cancelSeats(seats);
+                        removeTicket(ticket);
+                        cout << "All seats canceled, ticket removed.\n";
                     }
                     else
                     {
-                        cout << "Cancellation failed: Some seats were not booked.\n";
+
+                        movie->cancelSeats(seats);
+                        ticket->removeSeats(seats, movie->pricePerSeat);
+                        cout << "Seats canceled successfully.\n";
                     }
                 }
                 else
                 {
-                    cout << "Cancellation failed: Movie not found.\n";
+                    cout << "Cancellation failed: Some seats were not booked.\n";
                 }
             }
             else
             {
-                cout << "Ticket not found.\n";
+                cout << "Cancellation failed: Movie not found.\n";
             }
         }
+        else
+        {
+            cout << "Ticket not found.\n";
+        }
+    }
+
+    Ticket *getTicket(const string &name, PhoneKey mobile, const string &title, const string &timing)
+    {
+        Symbol nameId = symbols.find(name), titleId = symbols.find(title), timingId = symbols.find(timing);
+        if (nameId == SymbolTable::none || titleId == SymbolTable::none || timingId == SymbolTable::none)
+            return nullptr; // Never interned, so no ticket can carry it
+        return findTicket(nameId, mobile, titleId, timingId);
+    }
 
-        Ticket *getTicket(const string &name, const string &mobile, const string &title, string timing)
+    Ticket *findTicket(Symbol name, PhoneKey mobile, Symbol title, Symbol timing)
+    {
+        for (int position : ticketIndex.find(mobile))
         {
-            for (auto &ticket : tickets)
+            Ticket *ticket = tickets[position];
+            if (ticket->customerName == name && ticket->movieTitle == title && ticket->movieTiming == timing)
             {
-                if (ticket->customerName == name && ticket->mobileNumber == mobile && ticket->movieTitle == title && ticket->movieTiming == timing)
-                {
-                    return ticket;
-                }
+                return ticket;
             }
-            return nullptr;
         }
+        return nullptr;
+    }
 
-        void retrieveTicket(const string &name, const string &title, const string &mobile, const string &timing)
+    void retrieveTicket(const string &name, const string &title, PhoneKey mobile, const string &timing)
+    {
+        Ticket *ticket = getTicket(name, mobile, title, timing);
+        if (ticket)
         {
-            Ticket *ticket = getTicket(name, mobile, title, timing);
-            if (ticket)
-            {
-                ticket->display();
-            }
-            else
-            {
-                cout << "Ticket not found.\n";
-            }
+            ticket->display();
+        }
+        else
+        {
+            cout << "Ticket not found.\n";
+        }
+    }
+
+    bool isValidPhoneNumber(const string &mobile)
+    {
+        return PhoneKey(mobile).valid();
+    }
+
+    // Offers the best blocks of adjacent seats and fills `seats` with the one picked
+    bool chooseBestSeats(const string &title, const string &time, int numSeats, vector<int> &seats)
+    {
+        Movie *movie = getMovie(title, time);
+        if (!movie)
+        {
+            cout << "Movie or timing not found.\n";
+            return false;
+        }
+        vector<SeatBlock> blocks = movie->seats.findBestSeats(numSeats);
+        if (blocks.empty())
+        {
+            cout << "No " << numSeats << " adjacent seats available.\n";
+            return false;
+        }
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            cout << i + 1 << ". Row " << blocks[i].row + 1 << ", seats " << blocks[i].firstSeat
+                 << "-" << blocks[i].firstSeat + blocks[i].count - 1 << endl;
+        }
+        cout << "Choose an option: ";
+        int option;
+        cin >> option;
+        if (option < 1 || option > (int)blocks.size())
+        {
+            cout << "Invalid option.\n";
+            return false;
+        }
+        for (int i = 0; i < numSeats; i++)
+        {
+            seats.push_back(blocks[option - 1].firstSeat + i);
         }
+        return true;
+    }
 
-        bool isValidPhoneNumber(const string &mobile)
+    void run_choice_2()
+    { // Book Ticket
+        string name, mobile, title, time;
+        int seat;
+        vector<int> seats;
+        bool isVIP = false;
+        cout << "Enter name: ";
+        cin.ignore();
+        getline(cin, name);
+        cout << "Enter mobile: ";
+        cin >> mobile;
+        while (!isValidPhoneNumber(mobile))
         {
-            if (mobile.length() != 10)
-                return false;
-            return all_of(mobile.begin(), mobile.end(), ::isdigit);
-        }
-
-        void run_choice_2()
-        { // Book Ticket
-            string name, mobile, title, time;
-            int seat;
-            vector<int> seats;
-            bool isVIP = false;
-            cout << "Enter name: ";
-            cin.ignore();
-            getline(cin, name);
-            cout << "Enter mobile: ";
+            cout << "Please enter a valid phone number: ";
             cin >> mobile;
-            while (!isValidPhoneNumber(mobile))
-            {
-                cout << "Please enter a valid phone number: ";
-                cin >> mobile;
-            }
-            cout << "Enter movie title: ";
-            cin.ignore();
-            getline(cin, title);
-            cout << "Enter movie timing: ";
-            getline(cin, time);
-            cout << "Enter number of seats to book: ";
-            int numSeats;
-            cin >> numSeats;
+        }
+        cout << "Enter movie title: ";
+        cin.ignore();
+        getline(cin, title);
+        cout << "Enter movie timing: ";
+        getline(cin, time);
+        cout << "Enter number of seats to book: ";
+        int numSeats;
+        cin >> numSeats;
+        cout << "Pick the best available seats for you? (1 for Yes, 0 for No): ";
+        bool bestAvailable = false;
+        cin >> bestAvailable;
+        if (bestAvailable)
+        {
+            if (!chooseBestSeats(title, time, numSeats, seats))
+                return;
+        }
+        else
+        {
             cout << "Enter seat numbers (space-separated): ";
             for (int i = 0; i < numSeats; i++)
             {
                 cin >> seat;
                 seats.push_back(seat);
             }
-            cout << "Is this a VIP booking? (1 for Yes, 0 for No): ";
-            cin >> isVIP;
-            bookTicket(name, mobile, title, time, seats, isVIP);
-        }
-
-        void run_choice_3()
-        { // Cancel Ticket
-            string name, mobile, title, time;
-            int seat;
-            vector<int> seats;
-            cout << "Enter name: ";
-            cin.ignore();
-            getline(cin, name);
-            cout << "Enter mobile: ";
+        }
+        cout << "Is this a VIP booking? (1 for Yes, 0 for No): ";
+        cin >> isVIP;
+        bookTicket(name, PhoneKey(mobile), title, time, seats, isVIP);
+    }
+
+    void run_choice_3()
+    { // Cancel Ticket
+        string name, mobile, title, time;
+        int seat;
+        vector<int> seats;
+        cout << "Enter name: ";
+        cin.ignore();
+        getline(cin, name);
+        cout << "Enter mobile: ";
+        cin >> mobile;
+        while (!isValidPhoneNumber(mobile))
+        {
+            cout << "Please enter a valid phone number: ";
             cin >> mobile;
-            while (!isValidPhoneNumber(mobile))
-            {
-                cout << "Please enter a valid phone number: ";
-                cin >> mobile;
-            }
-            cout << "Enter movie title: ";
-            cin.ignore();
-            getline(cin, title);
-            cout << "Enter movie timing: ";
-            getline(cin, time);
-            cout << "Enter number of seats to cancel: ";
-            int numSeats;
-            cin >> numSeats;
-            cout << "Enter seat numbers (space-separated): ";
-            for (int i = 0; i < numSeats; i++)
+        }
+        cout << "Enter movie title: ";
+        cin.ignore();
+        getline(cin, title);
+        cout << "Enter movie timing: ";
+        getline(cin, time);
+        cout << "Enter number of seats to cancel: ";
+        int numSeats;
+        cin >> numSeats;
+        cout << "Enter seat numbers (space-separated): ";
+        for (int i = 0; i < numSeats; i++)
+        {
+            cin >> seat;
+            seats.push_back(seat);
+        }
+        cancelTicket(name, PhoneKey(mobile), title, seats, time);
+    }
+
+    void run_choice_4()
+    { // Retrieve Ticket
+        string name, mobile, title, time;
+        cout << "Enter name: ";
+        cin.ignore();
+        getline(cin, name);
+        cout << "Enter mobile: ";
+        cin >> mobile;
+        while (!isValidPhoneNumber(mobile))
+        {
+            cout << "Please enter a valid phone number: ";
+            cin >> mobile;
+        }
+        cout << "Enter movie title: ";
+        cin.ignore();
+        getline(cin, title);
+        cout << "Enter movie timing: ";
+        getline(cin, time);
+        retrieveTicket(name, title, PhoneKey(mobile), time);
+    }
+};
+
+// Best-available benchmark (run with --bench): queries on a 2,000 seat hall,
+// then on the other layouts: a 30 seat screening room, a 50 seat screen split
+// by a centre aisle, a 288 seat hall with two aisles and rows too wide for one word
+void runBestSeatsBenchmark()
+{
+    const int queries = 1000000;
+#ifdef __AVX2__
+    const char *path = "AVX2";
+#else
+    const char *path = "scalar";
+#endif
+    for (auto layout : {HallLayout::grid("Benchmark", 40, 50), HallLayout::grid("Screening Room", 3, 10),
+                        HallLayout::grid("Screen 1", 5, 10, 5), HallLayout::grid("Grand Hall", 12, 24, 8),
+                        HallLayout::grid("Wide Hall", 10, 108)})
+    {
+        AtomicSeatMap hall(layout);
+        mt19937 rng(7);
+        for (int seat = 1; seat <= hall.size(); seat++)
+        {
+            if (rng() % 10 < 6) // About 60% of the hall already sold
+                hall.claimAll({seat});
+        }
+
+        long long found = 0;
+        auto start = chrono::steady_clock::now();
+        for (int q = 0; q < queries; q++)
+        {
+            found += hall.findBestSeats(q % 8 + 1).size();
+        }
+        auto end = chrono::steady_clock::now();
+
+        cout << "findBestSeats on " << layout->name() << ", " << layout->rowCount() << "x" << layout->columnCount()
+             << " (" << path << "): " << fixed << setprecision(1)
+             << chrono::duration<double, nano>(end - start).count() / queries << " ns/query, " << found << " blocks found\n";
+    }
+}
+
+// Ticket allocation benchmark (run with --bench): the same mix of bookings and
+// cancellations with new/delete and with ObjectPool, then repeated scans over
+// the tickets still live
+struct HeapTickets
+{
+    template <typename T, typename... Args>
+    T *create(Args &&...args) { return new T(std::forward<Args>(args)...); }
+    void destroy(Ticket *ticket) { delete ticket; }
+};
+
+void runTicketPoolBenchmark()
+{
+    const int bookings = 500000, scans = 20;
+    vector<string> names;
+    vector<PhoneKey> phones;
+    for (int i = 0; i < 1000; i++)
+    {
+        names.push_back("Customer " + to_string(i));
+        phones.push_back(PhoneKey(to_string(9000000000LL + i)));
+        symbols.intern(names.back()); // So neither run pays for interning
+    }
+    symbols.intern("Avatar");
+    symbols.intern("6:00 PM");
+    vector<vector<int>> seatSets;
+    for (int seat = 1; seat <= 50; seat++)
+        seatSets.push_back({seat});
+
+    auto run = [&](auto &store, const char *label)
+    {
+        mt19937 rng(5);
+        vector<Ticket *> tickets;
+        tickets.reserve(bookings);
+        size_t allocationsBefore = heapAllocations.load();
+        for (int i = 0; i < bookings; i++)
+        {
+            int customer = rng() % 1000;
+            const vector<int> &seats = seatSets[rng() % 50];
+            if (rng() % 5 == 0)
+                tickets.push_back(store.template create<VIPTicket>(names[customer], phones[customer], "Avatar", "6:00 PM", seats, 10.0));
+            else
+                tickets.push_back(store.template create<StandardTicket>(names[customer], phones[customer], "Avatar", "6:00 PM", seats, 10.0));
+            if (rng() % 3 == 0) // A third of the time someone cancels
             {
-                cin >> seat;
-                seats.push_back(seat);
+                size_t victim = rng() % tickets.size();
+                store.destroy(tickets[victim]);
+                tickets[victim] = tickets.back();
+                tickets.pop_back();
             }
-            cancelTicket(name, mobile, title, seats, time);
         }
+        size_t allocations = heapAllocations.load() - allocationsBefore; // 0 unless built with -DCOUNT_ALLOCATIONS
 
-        void run_choice_4()
-        { // Retrieve Ticket
-            string name, mobile, title, time;
-            cout << "Enter name: ";
-            cin.ignore();
-            getline(cin, name);
-            cout << "Enter mobile: ";
-            cin >> mobile;
-            while (!isValidPhoneNumber(mobile))
+        double revenue = 0;
+        auto start = chrono::steady_clock::now();
+        for (int pass = 0; pass < scans; pass++)
+        {
+            for (const Ticket *ticket : tickets)
             {
-                cout << "Please enter a valid phone number: ";
-                cin >> mobile;
+                if (ticket->mobileNumber.packed() % 7 == 0)
+                    revenue += ticket->totalPrice;
             }
-            cout << "Enter movie title: ";
-            cin.ignore();
-            getline(cin, title);
-            cout << "Enter movie timing: ";
-            getline(cin, time);
-            retrieveTicket(name, title, mobile, time);
         }
+        auto end = chrono::steady_clock::now();
+
+        cout << label << ": " << fixed << setprecision(2);
+        if (allocations > 0)
+            cout << double(allocations) / bookings << " allocations per booking, ";
+        cout << chrono::duration<double, nano>(end - start).count() / (double(scans) * tickets.size())
+             << " ns per ticket scanned (" << tickets.size() << " live, revenue " << setprecision(0) << revenue << ")\n";
+
+        for (Ticket *ticket : tickets)
+            store.destroy(ticket);
     };
 
-    int main()
+    HeapTickets heap;
+    run(heap, "Tickets with new/delete");
+    ObjectPool<Ticket, StandardTicket, VIPTicket> pool;
+    run(pool, "Tickets in ObjectPool  ");
+}
+
+// Column store benchmark (run with --bench): a million pooled tickets and ten
+// thousand movies, summed, repriced and listed through the class hierarchy and
+// through TicketColumns/MovieColumns
+void runColumnBenchmark()
+{
+    const int ticketCount = 1000000, titleCount = 200, movieCount = 10000, listed = 100000;
+    mt19937 rng(9);
+    vector<Symbol> titles;
+    for (int i = 0; i < titleCount; i++)
+        titles.push_back(symbols.intern("Feature " + to_string(i)));
+    auto hall = HallLayout::grid("Benchmark", 20, 50);
+
+    ObjectPool<Ticket, StandardTicket, VIPTicket> ticketPool;
+    vector<Ticket *> tickets;
+    for (int i = 0; i < ticketCount; i++)
     {
-        BookingSystem bookingSystem;
-        // Example movies added
-        bookingSystem.addMovie(new RegularMovie("Avatar", "6:00 PM", 10.00));
-        bookingSystem.addMovie(new PremiumMovie("Titanic", "8:00 PM", 10.00));
+        const string &title = symbols.str(titles[rng() % titleCount]);
+        PhoneKey phone(to_string(9000000000LL + rng() % 100000));
+        vector<int> seats;
+        for (int k = rng() % 4; k >= 0; k--)
+            seats.push_back(rng() % 1000 + 1);
+        if (rng() % 5 == 0)
+            tickets.push_back(ticketPool.create<VIPTicket>("Guest", phone, title, "7:00 PM", seats, 12.0));
+        else
+            tickets.push_back(ticketPool.create<StandardTicket>("Guest", phone, title, "7:00 PM", seats, 12.0));
+    }
+    TicketColumns columns;
+    for (const Ticket *ticket : tickets)
+        columns.add(*ticket);
 
-        int choice;
-        do
-        {
-            cout << "\n1. Show Movies\n2. Book Ticket\n3. Cancel Ticket\n4. Retrieve Ticket\n5. Exit\nEnter your choice: ";
-            cin >> choice;
+    ObjectPool<Movie, RegularMovie, PremiumMovie> moviePool;
+    vector<Movie *> movies;
+    MovieColumns movieColumns;
+    for (int i = 0; i < movieCount; i++)
+    {
+        const string &title = symbols.str(titles[i % titleCount]);
+        if (i % 4 == 0)
+            movies.push_back(moviePool.create<PremiumMovie>(title, "9:30 PM", 10.0, hall));
+        else
+            movies.push_back(moviePool.create<RegularMovie>(title, "9:30 PM", 10.0, hall));
+        movieColumns.add(*movies.back());
+    }
 
-            switch (choice)
+    auto timeIt = [](auto work, double rows)
+    {
+        auto start = chrono::steady_clock::now();
+        work();
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / rows;
+    };
+    const int passes = 20;
+
+    double pointerRevenue = 0, columnRevenue = 0;
+    double revenuePointer = timeIt([&]()
+                                   { for (int p = 0; p < passes; p++) { pointerRevenue = 0; for (const Ticket *t : tickets) pointerRevenue += t->totalPrice; } },
+                                   double(passes) * ticketCount);
+    double revenueColumns = timeIt([&]()
+                                   { for (int p = 0; p < passes; p++) columnRevenue = columns.revenue(); },
+                                   double(passes) * ticketCount);
+
+    double repricePointer = timeIt([&]()
+                                   {
+        for (int p = 0; p < passes; p++)
+        {
+            Symbol title = titles[p];
+            for (Ticket *t : tickets)
             {
-            case 1:
-                bookingSystem.showMovies();
-                break;
-            case 2:
-                bookingSystem.run_choice_2();
-                break;
-            case 3:
-                bookingSystem.run_choice_3();
-                break;
-            case 4:
-                bookingSystem.run_choice_4();
-                break;
-            case 5:
-                cout << "Exiting...\n";
-                break;
-            default:
-                cout << "Invalid choice, please try again.\n";
+                if (t->movieTitle == title)
+                    t->totalPrice = t->bookedSeats.size() * 15.0 * t->priceMultiplier();
             }
-        } while (choice != 5);
+        } },
+                                   double(passes) * ticketCount);
+    double repriceColumns = timeIt([&]()
+                                   { for (int p = 0; p < passes; p++) columns.reprice(titles[p], 15.0); },
+                                   double(passes) * ticketCount);
+    bool revenueMatches = fabs(pointerRevenue - columnRevenue) < 1e-6 * columnRevenue &&
+                          fabs(accumulate(tickets.begin(), tickets.end(), 0.0, [](double sum, const Ticket *t)
+                                          { return sum + t->totalPrice; }) -
+                               columns.revenue()) < 1e-6 * columns.revenue();
+
+    ostringstream pointerText, columnText;
+    double listPointer = timeIt([&]()
+                                { for (int i = 0; i < listed; i++) tickets[i]->display(pointerText); },
+                                listed);
+    TicketColumns head;
+    for (int i = 0; i < listed; i++)
+        head.add(*tickets[i]);
+    double listColumns = timeIt([&]()
+                                { head.list(columnText); },
+                                listed);
+
+    ostringstream moviePointerText, movieColumnText;
+    double moviesPointer = timeIt([&]()
+                                  { for (const Movie *m : movies) m->display(moviePointerText); },
+                                  movieCount);
+    double moviesColumns = timeIt([&]()
+                                  { movieColumns.list(movieColumnText); },
+                                  movieCount);
+
+    bool sameText = pointerText.str() == columnText.str() && moviePointerText.str() == movieColumnText.str();
+    cout << fixed << setprecision(2)
+         << "Tickets, ns per row (pointers vs columns): revenue " << revenuePointer << " vs " << revenueColumns
+         << ", reprice " << repricePointer << " vs " << repriceColumns
+         << ", list " << listPointer << " vs " << listColumns << "\n"
+         << "Movies, ns per row (pointers vs columns): list " << moviesPointer << " vs " << moviesColumns
+         << (revenueMatches && sameText ? " (same revenue and text)" : " (MISMATCH)") << "\n";
+
+    for (Ticket *ticket : tickets)
+        ticketPool.destroy(ticket);
+    for (Movie *movie : movies)
+        moviePool.destroy(movie);
+}
+
+// Allocation check (run with --alloc in a -DCOUNT_ALLOCATIONS build): books and cancels through the string
+// API, as the console does, and through the id API, counting heap allocations
+// per booking. The id API must not allocate once the pool is warm.
+int runAllocationCheck()
+{
+#ifndef COUNT_ALLOCATIONS
+    cout << "Allocations are only counted in a build with -DCOUNT_ALLOCATIONS\n";
+    return 1;
+#endif
+    const int customerCount = 1000, rounds = 5;
+    BookingSystem system;
+    system.addMovie<RegularMovie>("The Shawshank Redemption", "7:00 PM", 10.00, HallLayout::grid("Big Hall", 20, 50, 25));
+
+    vector<string> names;
+    vector<PhoneKey> mobiles;
+    for (int i = 0; i < customerCount; i++)
+    {
+        names.push_back("Customer Number " + to_string(i)); // Too long to fit inline in a string
+        mobiles.push_back(PhoneKey(to_string(9000000000LL + i)));
+    }
+    string_view title = "The Shawshank Redemption", timing = "7:00 PM";
+
+    // String API, with the caller holding its text as views
+    streambuf *console = cout.rdbuf(nullptr); // The string API reports to the console
+    size_t before = heapAllocations.load();
+    for (int i = 0; i < customerCount; i++)
+    {
+        system.bookTicket(string(names[i]), mobiles[i], string(title), string(timing), {i + 1}, i % 5 == 0);
+        system.cancelTicket(string(names[i]), mobiles[i], string(title), {i + 1}, string(timing));
+    }
+    double stringApi = double(heapAllocations.load() - before) / customerCount;
+    cout.rdbuf(console);
+    cout.clear();
+
+    // Id API: resolve everything once, then warm up the pool and ticket list
+    int show = system.findShow(title, timing);
+    vector<Symbol> customers;
+    for (const string &name : names)
+        customers.push_back(symbols.intern(name));
+    vector<vector<int>> seats;
+    for (int i = 0; i < customerCount; i++)
+        seats.push_back({i + 1});
+    vector<Ticket *> booked(customerCount);
+    for (int i = 0; i < customerCount; i++)
+        booked[i] = system.book(customers[i], mobiles[i], show, seats[i], i % 5 == 0);
+    for (int i = 0; i < customerCount; i++)
+        system.cancel(booked[i], seats[i]);
+
+    before = heapAllocations.load();
+    bool ok = true;
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int i = 0; i < customerCount; i++)
+        {
+            booked[i] = system.book(customers[i], mobiles[i], show, seats[i], i % 5 == 0);
+            ok = ok && booked[i];
+        }
+        for (int i = 0; i < customerCount; i++)
+            ok = ok && system.cancel(booked[i], seats[i]);
+    }
+    size_t idApi = heapAllocations.load() - before;
+
+    cout << fixed << setprecision(2)
+         << "string API: " << stringApi << " allocations per booking\n"
+         << "id API:     " << double(idApi) / (customerCount * rounds) << " allocations per booking\n";
+    return (ok && idApi == 0) ? 0 : 1;
+}
+
+// Seat set regression check (run with --seat-check): INT32_MAX marks the empty
+// inline slots, so it must never be found on, or cancelled from, a ticket that
+// does not hold it. Also checks that long rows pick the block nearest the centre
+int runSeatSetCheck()
+{
+    const int marker = INT32_MAX;
+    bool ok = true;
+    auto expect = [&ok](bool condition, const char *what)
+    {
+        if (!condition)
+        {
+            cout << "FAILED: " << what << "\n";
+            ok = false;
+        }
+    };
+
+    SeatSet seats;
+    seats.insert(1);
+    seats.insert(2);
+    seats.insert(3);
+    expect(!seats.contains(marker), "a 3 seat set contains INT32_MAX");
+    expect(!seats.erase(marker) && seats.size() == 3 && seats.contains(3), "erasing INT32_MAX drops a real seat");
+    expect(seats.insert(marker) && seats.contains(marker) && seats.erase(marker) && seats.size() == 3,
+           "INT32_MAX cannot be held as a real seat");
+    expect(!seats.insert(0) && !seats.insert(-1) && seats.size() == 3, "a set takes a seat below 1");
+    for (int seat = 4; seat <= 9; seat++)
+        seats.insert(seat); // Spills to the bitmap
+    expect(!seats.contains(marker) && !seats.erase(marker) && seats.size() == 9, "a spilled set contains INT32_MAX");
+    expect(!seats.insert(0) && !seats.insert(-1000000) && seats.size() == 9, "a spilled set takes a seat below 1");
+
+    BookingSystem system;
+    system.addMovie<RegularMovie>("Avengers", "10:00 AM", 10.0, HallLayout::grid("Main Hall", 5, 10));
+    Movie *movie = system.getMovie("Avengers", "10:00 AM");
+    Ticket *ticket = system.book(symbols.intern("Ann"), PhoneKey("9876543210"), system.findShow("Avengers", "10:00 AM"), {1, 2, 3});
+    expect(!system.cancel(ticket, {marker}), "cancelling seat 2147483647 succeeds");
+    expect(ticket->bookedSeats.size() == 3 && !movie->seats.isFree(3), "cancelling seat 2147483647 changes the ticket");
 
+    // Rows wider than one word take the scalar path, which must pick the same
+    // block as the one-word path: with column 53 of 108 taken, 54 is nearer the
+    // centre (53.5) than 52
+    AtomicSeatMap wide(HallLayout::grid("Wide Hall", 1, 108));
+    expect(wide.claimAll({54}), "cannot claim seat 54 of a 108 seat row");
+    vector<SeatBlock> blocks = wide.findBestSeats(1, 1);
+    expect(blocks.size() == 1 && blocks[0].firstSeat == 55, "a 108 seat row does not offer the seat nearest the centre");
+
+    cout << (ok ? "Seat set check passed\n" : "Seat set check failed\n");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+    {
+        runBestSeatsBenchmark();
+        runTicketPoolBenchmark();
+        runColumnBenchmark();
         return 0;
     }
+    if (argc > 1 && string(argv[1]) == "--seat-check")
+    {
+        return runSeatSetCheck();
+    }
+    if (argc > 1 && string(argv[1]) == "--alloc")
+    {
+        return runAllocationCheck();
+    }
+
+    BookingSystem bookingSystem;
+    auto mainHall = HallLayout::grid("Main Hall", 5, 10); // 50 seats
+
+    // Example movies added
+    bookingSystem.addMovie<RegularMovie>("Avatar", "6:00 PM", 10.00, mainHall);
+    bookingSystem.addMovie<PremiumMovie>("Titanic", "8:00 PM", 10.00, mainHall);
+
+    int choice;
+    do
+    {
+        cout << "\n1. Show Movies\n2. Book Ticket\n3. Cancel Ticket\n4. Retrieve Ticket\n5. Exit\nEnter your choice: ";
+        cin >> choice;
+
+        switch (choice)
+        {
+        case 1:
+            bookingSystem.showMovies();
+            break;
+        case 2:
+            bookingSystem.run_choice_2();
+            break;
+        case 3:
+            bookingSystem.run_choice_3();
+            break;
+        case 4:
+            bookingSystem.run_choice_4();
+            break;
+        case 5:
+            cout << "Exiting...\n";
+            break;
+        default:
+            cout << "Invalid choice, please try again.\n";
+        }
+    } while (choice != 5);
+
+    return 0;
+}
@@ -1,27 +1,409 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <iomanip>
 #include <algorithm>
-#include <set>
+#include <atomic>
+#include <optional>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <charconv>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <csignal>
+#endif
 
 using namespace std;
 
-class Movie
+// Seat map that many threads can book from at once. One bit per seat (set = free)
+// packed into 64-bit atomic words; a booking claims all of its seats with
+// compare-and-swap, one word at a time, and rolls back if any seat is gone.
+class AtomicSeatMap
 {
+private:
+    unique_ptr<atomic<uint64_t>[]> words;
+    size_t wordCount;
+    int totalSeats;
+
+    // Groups seat numbers into (word index, bit mask) pairs, in word order
+    static bool buildMasks(const vector<int> &seatNumbers, int totalSeats, vector<pair<size_t, uint64_t>> &masks)
+    {
+        for (int seat : seatNumbers)
+        {
+            if (seat < 1 || seat > totalSeats)
+                return false;
+            masks.push_back({size_t(seat - 1) >> 6, 1ULL << ((seat - 1) & 63)});
+        }
+        sort(masks.begin(), masks.end());
+        size_t out = 0;
+        for (size_t i = 0; i < masks.size(); i++)
+        {
+            if (out > 0 && masks[out - 1].first == masks[i].first)
+                masks[out - 1].second |= masks[i].second;
+            else
+                masks[out++] = masks[i];
+        }
+        masks.resize(out);
+        return true;
+    }
+
 public:
-    string title, timing;
-    double pricePerSeat;
-    vector<bool> seats;
+    AtomicSeatMap(int seatCount)
+        : words(new atomic<uint64_t>[(seatCount + 63) / 64]), wordCount((seatCount + 63) / 64), totalSeats(seatCount)
+    {
+        for (size_t w = 0; w < wordCount; w++)
+        {
+            words[w].store(~0ULL, memory_order_relaxed);
+        }
+        if (seatCount % 64 != 0)
+        {
+            words[wordCount - 1].store((1ULL << (seatCount % 64)) - 1, memory_order_relaxed);
+        }
+    }
+
+    int size() const { return totalSeats; }
+
+    bool isFree(int seat) const
+    {
+        return (words[(seat - 1) >> 6].load(memory_order_acquire) >> ((seat - 1) & 63)) & 1ULL;
+    }
+
+    // Claims every seat in seatNumbers, or none of them
+    bool claimAll(const vector<int> &seatNumbers)
+    {
+        vector<pair<size_t, uint64_t>> masks;
+        if (!buildMasks(seatNumbers, totalSeats, masks))
+            return false;
+
+        for (size_t i = 0; i < masks.size(); i++)
+        {
+            atomic<uint64_t> &word = words[masks[i].first];
+            uint64_t mask = masks[i].second;
+            uint64_t current = word.load(memory_order_relaxed);
+            do
+            {
+                if ((current & mask) != mask)
+                {
+                    // Someone else holds one of these seats: give back what we took
+                    for (size_t j = 0; j < i; j++)
+                    {
+                        words[masks[j].first].fetch_or(masks[j].second, memory_order_release);
+                    }
+                    return false;
+                }
+            } while (!word.compare_exchange_weak(current, current & ~mask, memory_order_acq_rel, memory_order_relaxed));
+        }
+        return true;
+    }
+
+    // Frees one seat, returns false if it was not booked
+    bool release(int seat)
+    {
+        if (seat < 1 || seat > totalSeats)
+            return false;
+        uint64_t mask = 1ULL << ((seat - 1) & 63);
+        return !(words[(seat - 1) >> 6].fetch_or(mask, memory_order_acq_rel) & mask);
+    }
+
+    size_t wordSize() const { return wordCount; }
+
+    // Raw seat words, for snapshots
+    void copyWords(uint64_t *out) const
+    {
+        for (size_t w = 0; w < wordCount; w++)
+        {
+            out[w] = words[w].load(memory_order_acquire);
+        }
+    }
+
+    void loadWords(const uint64_t *in)
+    {
+        for (size_t w = 0; w < wordCount; w++)
+        {
+            words[w].store(in[w], memory_order_release);
+        }
+    }
+
+    int freeCount() const
+    {
+        int count = 0;
+        for (size_t w = 0; w < wordCount; w++)
+        {
+            count += __builtin_popcountll(words[w].load(memory_order_acquire));
+        }
+        return count;
+    }
+};
+
+// Minutes since midnight for a timing such as "10:00 AM", "1:00 PM" or "19:30",
+// or -1 if the timing cannot be read
+int parseTiming(string_view timing)
+{
+    size_t i = 0;
+    int hours = 0, minutes = 0, digits = 0;
+    while (i < timing.size() && isdigit((unsigned char)timing[i]) && digits < 2)
+    {
+        hours = hours * 10 + (timing[i++] - '0');
+        digits++;
+    }
+    if (digits == 0 || i + 3 > timing.size() || timing[i] != ':' ||
+        !isdigit((unsigned char)timing[i + 1]) || !isdigit((unsigned char)timing[i + 2]))
+        return -1;
+    minutes = (timing[i + 1] - '0') * 10 + (timing[i + 2] - '0');
+    i += 3;
+    while (i < timing.size() && timing[i] == ' ')
+        i++;
+
+    if (i == timing.size())
+        return (hours < 24 && minutes < 60) ? hours * 60 + minutes : -1; // 24-hour clock
+    if (i + 2 != timing.size() || toupper(timing[i + 1]) != 'M' || hours < 1 || hours > 12 || minutes >= 60)
+        return -1;
+    char half = toupper(timing[i]);
+    if (half != 'A' && half != 'P')
+        return -1;
+    return ((hours % 12) + (half == 'P' ? 12 : 0)) * 60 + minutes;
+}
+
+// Shows grouped by start minute, so listing them in time order needs no sort.
+// There is one bucket per minute of the day plus a last one for timings that
+// could not be read, and a bitmap of the buckets in use.
+class ScheduleIndex
+{
+private:
+    static const int buckets = 24 * 60 + 1;
+    vector<vector<int>> byMinute; // Positions of the shows, in the order they were added
+    uint64_t used[(buckets + 63) / 64] = {};
+
+public:
+    ScheduleIndex() : byMinute(buckets) {}
+
+    void insert(int startMinute, int position)
+    {
+        int bucket = startMinute < 0 ? buckets - 1 : startMinute;
+        byMinute[bucket].push_back(position);
+        used[bucket / 64] |= 1ULL << (bucket % 64);
+    }
+
+    // Calls fn(position) for every show, earliest first
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        for (int w = 0; w < (buckets + 63) / 64; w++)
+        {
+            uint64_t word = used[w];
+            while (word)
+            {
+                for (int position : byMinute[w * 64 + __builtin_ctzll(word)])
+                {
+                    fn(position);
+                }
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+// Spreads the bits of an integer key for open-addressing tables (splitmix64 finaliser)
+inline size_t mixHash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    return key ^ (key >> 33);
+}
+
+// Id of a string in the global symbol table
+typedef uint32_t Symbol;
+
+// Global symbol table: every distinct title, timing and customer name is
+// stored once and referred to by a 32-bit id, so comparing two of them
+// is an integer compare. Lookups of known strings go through an open-addressing
+// table and never allocate.
+class SymbolTable
+{
+private:
+    vector<string> strings;
+    vector<Symbol> slots; // Symbol + 1, 0 = empty; size is a power of two
+    size_t textBytes = 0;
+
+    static uint64_t hashOf(string_view s)
+    {
+        uint64_t h = 14695981039346656037ULL; // FNV-1a
+        for (unsigned char c : s)
+        {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // Slot holding s, or the empty slot where it would go
+    size_t probe(string_view s) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = hashOf(s) & mask;
+        while (slots[i] != 0 && strings[slots[i] - 1] != s)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        slots.assign(max<size_t>(16, slots.size() * 2), 0);
+        for (size_t id = 0; id < strings.size(); id++)
+        {
+            slots[probe(strings[id])] = id + 1;
+        }
+    }
+
+public:
+    static const Symbol none = ~0u;
+
+    // Id of s, or none if it was never interned
+    Symbol find(string_view s) const
+    {
+        if (slots.empty())
+            return none;
+        return slots[probe(s)] - 1;
+    }
+
+    Symbol intern(string_view s)
+    {
+        if ((strings.size() + 1) * 2 > slots.size())
+            grow();
+        size_t i = probe(s);
+        if (slots[i] == 0)
+        {
+            strings.emplace_back(s);
+            slots[i] = strings.size();
+            textBytes += strings.back().capacity() > 15 ? strings.back().capacity() + 1 : 0; // Heap part, beyond the inline buffer
+        }
+        return slots[i] - 1;
+    }
+
+    const string &str(Symbol id) const { return strings[id]; }
+
+    size_t size() const { return strings.size(); }
+
+    // Bytes held by the table: the strings, their text and the hash slots
+    size_t memoryUsage() const
+    {
+        return strings.capacity() * sizeof(string) + textBytes + slots.capacity() * sizeof(Symbol);
+    }
+};
+
+SymbolTable symbols;
+
+// A 10 digit mobile number packed into an integer. Validation and packing
+// run on 8 digits at a time inside a 64-bit word (SWAR), so checking a
+// number is a few arithmetic ops with no per-character branches. Assumes a
+// little-endian target.
+class PhoneKey
+{
+private:
+    uint64_t value;
+
+    // True if all 8 bytes of chunk are ASCII digits
+    static bool eightDigits(uint64_t chunk)
+    {
+        return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+                (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+    }
+
+    // The 8 digits in chunk as a number, first character most significant
+    static uint32_t eightDigitValue(uint64_t chunk)
+    {
+        chunk = (chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+        chunk = (chunk & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+        return uint32_t((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+    }
+
+public:
+    static const uint64_t invalid = ~0ULL;
+
+    PhoneKey() : value(invalid) {}
+    explicit PhoneKey(string_view mobile) : value(parse(mobile.data(), mobile.size())) {}
+
+    // The number in text[0..length), or invalid unless it is exactly 10 digits
+    static uint64_t parse(const char *text, size_t length)
+    {
+        if (length != 10)
+            return invalid;
+        uint64_t chunk;
+        memcpy(&chunk, text, 8);
+        unsigned d8 = (unsigned char)text[8] - '0', d9 = (unsigned char)text[9] - '0';
+        if (!eightDigits(chunk) || d8 > 9 || d9 > 9)
+            return invalid;
+        return uint64_t(eightDigitValue(chunk)) * 100 + d8 * 10 + d9;
+    }
+
+    static PhoneKey fromPacked(uint64_t packed)
+    {
+        PhoneKey key;
+        key.value = packed;
+        return key;
+    }
 
-    Movie(string t, string time, double p) : title(t), timing(time), pricePerSeat(p)
+    bool valid() const { return value != invalid; }
+    uint64_t packed() const { return value; }
+
+    // Back to the 10 digit text, keeping leading zeros
+    string str() const
     {
-        seats.resize(50, true);
+        if (!valid())
+            return "";
+        string text(10, '0');
+        uint64_t rest = value;
+        for (int i = 9; i >= 0; i--)
+        {
+            text[i] = '0' + rest % 10;
+            rest /= 10;
+        }
+        return text;
     }
 
+    bool operator==(const PhoneKey &other) const { return value == other.value; }
+    bool operator!=(const PhoneKey &other) const { return value != other.value; }
+};
+
+class Movie
+{
+public:
+    Symbol title, timing;
+    int startMinute; // timing as minutes since midnight, -1 if unreadable
+    double pricePerSeat;
+    AtomicSeatMap seats;
+
+    Movie(string_view t, string_view time, double p, int seatCount)
+        : title(symbols.intern(t)), timing(symbols.intern(time)), startMinute(parseTiming(time)), pricePerSeat(p), seats(seatCount) {}
+
     void display()
     {
-        cout << "Title: " << title << ", Timing: " << timing << ", Price: $"
+        cout << "Title: " << symbols.str(title) << ", Timing: " << symbols.str(timing) << ", Price: $"
              << fixed << setprecision(2) << pricePerSeat << endl;
     }
 
@@ -32,7 +414,7 @@ public:
         {
             if (i % 5 == 0)
                 cout << endl;
-            if (seats[i])
+            if (seats.isFree(i + 1))
             {
                 cout << i + 1 << "  ";
                 if (i < 10)
@@ -48,12 +430,10 @@ public:
         cout << endl;
     }
 
-    void bookSeats(const vector<int> &seatNumbers)
+    // Books all the seats or none of them; safe to call from several threads
+    bool bookSeats(const vector<int> &seatNumbers)
     {
-        for (int seat : seatNumbers)
-        {
-            seats[seat - 1] = false; // Mark seat as booked
-        }
+        return seats.claimAll(seatNumbers);
     }
 
     void cancelSeats(const vector<int> &seatNumbers)
@@ -61,54 +441,214 @@ public:
         cout << "Cancelling seats: ";
         for (int seat : seatNumbers)
         {
-            if (!seats[seat - 1])
+            if (seats.release(seat))
             { // Only cancel if the seat is booked
-                seats[seat - 1] = true;
                 cout << seat << " ";
             }
         }
         cout << endl;
     }
 
-    bool checkBookSeats(const vector<int> &seatNumbers)
+    bool validSeat(const vector<int> &seatNumbers)
     {
         for (int seat : seatNumbers)
         {
-            if (!seats[seat - 1])
-                return false;
+            if (seat < 1 || seat > seats.size())
+                return true;
         }
-        return true;
+        return false;
     }
+};
 
-    bool validSeat(const vector<int> &seatNumbers)
+// Seats held by one ticket. Up to 8 seats live sorted in an inline array,
+// with unused slots set to a sentinel, so a lookup compares all 8 slots
+// without branching. A ticket with more seats spills to a bitmap indexed by
+// seat number, which never grows past the hall it was booked in. Neither
+// form allocates per seat.
+class SeatSet
+{
+private:
+    static const int inlineCapacity = 8;
+    static const int unused = INT32_MAX; // Sorts after every real seat
+
+    int count = 0;
+    int small[inlineCapacity] = {unused, unused, unused, unused, unused, unused, unused, unused};
+    vector<uint64_t> words; // Non-empty once spilled; bit s is seat s
+
+    bool spilled() const { return !words.empty(); }
+
+    bool bitmapHas(int seat) const
+    {
+        size_t w = size_t(seat) >> 6;
+        return seat >= 0 && w < words.size() && (words[w] >> (seat & 63) & 1);
+    }
+
+    void spill(int seat)
+    {
+        words.assign(size_t(max(seat, small[count - 1])) / 64 + 1, 0);
+        for (int i = 0; i < count; i++)
+        {
+            words[size_t(small[i]) >> 6] |= 1ULL << (small[i] & 63);
+            small[i] = unused;
+        }
+    }
+
+    // First seat at or after `seat`, or the end position
+    int nextSeat(int seat) const
+    {
+        size_t w = size_t(seat) >> 6;
+        if (w >= words.size())
+            return int(words.size() * 64);
+        uint64_t word = words[w] & (~0ULL << (seat & 63));
+        while (word == 0)
+        {
+            if (++w == words.size())
+                return int(words.size() * 64);
+            word = words[w];
+        }
+        return int(w * 64) + __builtin_ctzll(word);
+    }
+
+public:
+    class const_iterator
+    {
+    private:
+        const SeatSet *seats;
+        int position; // Slot while inline, seat number once spilled
+
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef int reference;
+
+        const_iterator(const SeatSet *s, int p) : seats(s), position(p) {}
+        int operator*() const { return seats->spilled() ? position : seats->small[position]; }
+        const_iterator &operator++()
+        {
+            position = seats->spilled() ? seats->nextSeat(position + 1) : position + 1;
+            return *this;
+        }
+        bool operator!=(const const_iterator &other) const { return position != other.position; }
+        bool operator==(const const_iterator &other) const { return position == other.position; }
+    };
+
+    SeatSet() {}
+
+    template <typename It>
+    SeatSet(It first, It last)
     {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    bool contains(int seat) const
+    {
+        if (spilled())
+            return bitmapHas(seat);
+        bool hit = false;
+        for (int i = 0; i < inlineCapacity; i++)
+            hit |= (small[i] == seat) & (i < count); // Empty slots hold `unused`, which is also a valid int
+        return hit;
+    }
+
+    // True if every seat in the range is in the set
+    template <typename Range>
+    bool containsAll(const Range &seatNumbers) const
+    {
+        bool all = true;
         for (int seat : seatNumbers)
+            all &= contains(seat);
+        return all;
+    }
+
+    // Adds a seat; false if it was already there or is not a seat number (< 1)
+    bool insert(int seat)
+    {
+        if (seat < 1 || contains(seat))
+            return false;
+        if (!spilled() && count == inlineCapacity)
+            spill(seat);
+        if (spilled())
         {
-            if (seat < 1 || seat > 50)
-                return true;
+            if (size_t(seat) / 64 >= words.size())
+                words.resize(size_t(seat) / 64 + 1, 0);
+            words[size_t(seat) >> 6] |= 1ULL << (seat & 63);
         }
-        return false;
+        else
+        {
+            int i = count;
+            while (i > 0 && small[i - 1] > seat) // Insertion sort keeps the slots ordered
+            {
+                small[i] = small[i - 1];
+                i--;
+            }
+            small[i] = seat;
+        }
+        count++;
+        return true;
+    }
+
+    template <typename It>
+    void insert(It first, It last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    // Removes a seat; false if it was not there
+    bool erase(int seat)
+    {
+        if (!contains(seat))
+            return false;
+        if (spilled())
+        {
+            words[size_t(seat) >> 6] &= ~(1ULL << (seat & 63));
+        }
+        else
+        {
+            int i = 0;
+            while (small[i] != seat)
+                i++;
+            for (; i < count - 1; i++)
+                small[i] = small[i + 1];
+            small[count - 1] = unused;
+        }
+        count--;
+        return true;
     }
+
+    const_iterator begin() const { return const_iterator(this, spilled() ? nextSeat(0) : 0); }
+    const_iterator end() const { return const_iterator(this, spilled() ? int(words.size() * 64) : count); }
 };
 
 class Ticket
 {
 public:
-    string customerName, mobileNumber, movieTitle, movieTiming;
-    set<int> bookedSeats;
+    Symbol customerName;
+    PhoneKey mobileNumber;
+    Symbol movieTitle, movieTiming;
+    SeatSet bookedSeats;
     double totalPrice;
 
-    Ticket(string name, string mobile, string title, string time, const vector<int> &seats, double pricePerSeat)
+    Ticket(Symbol name, PhoneKey mobile, Symbol title, Symbol time, const vector<int> &seats, double pricePerSeat)
         : customerName(name), mobileNumber(mobile), movieTitle(title), movieTiming(time)
     {
         bookedSeats.insert(seats.begin(), seats.end());
         totalPrice = bookedSeats.size() * pricePerSeat;
     }
 
-    void display()
+    Ticket(string_view name, PhoneKey mobile, string_view title, string_view time, const vector<int> &seats, double pricePerSeat)
+        : Ticket(symbols.intern(name), mobile, symbols.intern(title), symbols.intern(time), seats, pricePerSeat) {}
+
+    void display() const
     {
-        cout << "\n--- Ticket Details ---\nName: " << customerName << "\nMobile: " << mobileNumber
-             << "\nMovie: " << movieTitle << "\nTiming: " << movieTiming << "\nSeats: ";
+        cout << "\n--- Ticket Details ---\nName: " << symbols.str(customerName) << "\nMobile: " << mobileNumber.str()
+             << "\nMovie: " << symbols.str(movieTitle) << "\nTiming: " << symbols.str(movieTiming) << "\nSeats: ";
         for (int seat : bookedSeats)
             cout << seat << " ";
         cout << "\nTotal Price: $" << fixed << setprecision(2) << totalPrice << endl;
@@ -138,14 +678,7 @@ public:
 
     bool checkCancel(const vector<int> &seatNumbers)
     {
-        for (int seat : seatNumbers)
-        {
-            if (bookedSeats.find(seat) == bookedSeats.end())
-            {
-                return false;
-            }
-        }
-        return true;
+        return bookedSeats.containsAll(seatNumbers);
     }
 
     bool allSeatsCancel(const vector<int> &seatNumbers)
@@ -164,249 +697,2593 @@ public:
     }
 };
 
-class BookingSystem
+// Tickets in a generational slot map. A handle is a slot's generation in the
+// high 32 bits and its index in the low 32. Erasing bumps the generation and
+// puts the slot on a free list, so erase is O(1) with nothing shifting, and a
+// stale handle gets nullptr from get() instead of whichever ticket reuses the
+// slot later.
+class TicketSlotMap
 {
-    vector<Movie> movies;
-    vector<Ticket> tickets;
+private:
+    static const uint32_t endOfList = ~0u;
 
-public:
-    void addMovie(string title, string timing, double price)
+    struct Slot
     {
-        movies.push_back(Movie(title, timing, price));
-        sort(movies.begin(), movies.end(), [](Movie &a, Movie &b)
-             { return a.timing < b.timing; });
-    }
+        uint32_t generation = 1; // 0 is never issued, so handle 0 is never valid
+        uint32_t nextFree = endOfList;
+        optional<Ticket> ticket;
+    };
 
-    void showMovies()
+    vector<Slot> slots;
+    uint32_t freeHead = endOfList;
+    size_t live = 0;
+
+public:
+    typedef uint64_t Handle;
+    static const Handle none = 0;
+
+    static uint32_t indexOf(Handle handle) { return uint32_t(handle); }
+
+    // Handle of whatever currently lives in a slot
+    Handle handleAt(uint32_t index) const { return (uint64_t(slots[index].generation) << 32) | index; }
+
+    Handle insert(Ticket ticket)
     {
-        for (auto &movie : movies)
+        uint32_t index;
+        if (freeHead != endOfList)
         {
-            movie.display();
+            index = freeHead;
+            freeHead = slots[index].nextFree;
         }
+        else
+        {
+            index = slots.size();
+            slots.emplace_back();
+        }
+        slots[index].ticket.emplace(std::move(ticket));
+        live++;
+        return handleAt(index);
     }
 
-    Movie *getMovie(const string &title, const string &time)
+    Ticket *get(Handle handle)
     {
-        for (auto &movie : movies)
-        {
-            if (movie.title == title && movie.timing == time)
-                return &movie;
-        }
-        return nullptr;
+        uint32_t index = indexOf(handle);
+        if (index >= slots.size() || slots[index].generation != uint32_t(handle >> 32) || !slots[index].ticket)
+            return nullptr;
+        return &*slots[index].ticket;
     }
 
-    void showAvailableSeats(const string &title, const string &time)
+    const Ticket *get(Handle handle) const
     {
-        Movie *movie = getMovie(title, time);
-        if (movie)
-        {
-            movie->showAvailableSeats();
-        }
-        else
-        {
-            cout << "Movie or timing not found.\n";
-        }
+        return const_cast<TicketSlotMap *>(this)->get(handle);
     }
 
-    void bookTicket(string name, string mobile, string title, string time, const vector<int> &seats)
+    bool erase(Handle handle)
     {
-        Movie *movie = getMovie(title, time);
-        if (movie)
-        {
-            if (movie->validSeat(seats))
-            {
+        if (!get(handle))
+            return false;
+        Slot &slot = slots[indexOf(handle)];
+        slot.ticket.reset();
+        if (++slot.generation == 0)
+            slot.generation = 1;
+        slot.nextFree = freeHead;
+        freeHead = indexOf(handle);
+        live--;
+        return true;
+    }
+
+    size_t size() const { return live; }
+
+    void reserve(size_t count) { slots.reserve(count); }
+
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (const Slot &slot : slots)
+        {
+            if (slot.ticket)
+                f(*slot.ticket);
+        }
+    }
+};
+
+// Open-addressing index from a (title, timing) symbol pair to a movie's
+// position in the movies vector
+class ShowIndex
+{
+private:
+    struct Slot
+    {
+        uint64_t key;
+        int position; // -1 = empty
+    };
+
+    vector<Slot> slots; // Size is a power of two, at most half full
+    size_t used = 0;
+
+    static uint64_t keyOf(Symbol title, Symbol timing)
+    {
+        return (uint64_t(title) << 32) | timing;
+    }
+
+    size_t probe(uint64_t key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = mixHash(key) & mask;
+        while (slots[i].position >= 0 && slots[i].key != key)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        vector<Slot> old = slots;
+        slots.assign(max<size_t>(16, old.size() * 2), Slot{0, -1});
+        for (const Slot &slot : old)
+        {
+            if (slot.position >= 0)
+                slots[probe(slot.key)] = slot;
+        }
+    }
+
+public:
+    // Adds a show; the first movie added for a title and timing wins
+    void insert(Symbol title, Symbol timing, int position)
+    {
+        if ((used + 1) * 2 > slots.size())
+            grow();
+        uint64_t key = keyOf(title, timing);
+        size_t i = probe(key);
+        if (slots[i].position < 0)
+        {
+            slots[i] = Slot{key, position};
+            used++;
+        }
+    }
+
+    // Position of the movie, or -1 if there is no such show
+    int find(Symbol title, Symbol timing) const
+    {
+        if (title == SymbolTable::none || timing == SymbolTable::none || slots.empty())
+            return -1;
+        return slots[probe(keyOf(title, timing))].position;
+    }
+};
+
+// Secondary index from a customer's mobile number, as a PhoneKey, to the
+// slots of their tickets in the TicketSlotMap. Open addressing on the packed key; each customer
+// has only a few tickets, so lookup, insert and remove are O(1) amortised.
+class CustomerTicketIndex
+{
+private:
+    struct Slot
+    {
+        uint64_t key;
+        int list; // Index into lists, -1 = empty slot
+    };
+
+    vector<Slot> slots; // Size is a power of two, at most half full
+    vector<vector<int>> lists;
+
+    size_t probe(uint64_t key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = mixHash(key) & mask;
+        while (slots[i].list >= 0 && slots[i].key != key)
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow()
+    {
+        vector<Slot> old = slots;
+        slots.assign(max<size_t>(16, old.size() * 2), Slot{0, -1});
+        for (const Slot &slot : old)
+        {
+            if (slot.list >= 0)
+                slots[probe(slot.key)] = slot;
+        }
+    }
+
+    vector<int> *listFor(uint64_t key)
+    {
+        if (slots.empty())
+            return nullptr;
+        size_t i = probe(key);
+        return slots[i].list >= 0 ? &lists[slots[i].list] : nullptr;
+    }
+
+public:
+    void insert(PhoneKey mobile, int ticket)
+    {
+        uint64_t key = mobile.packed();
+        if ((lists.size() + 1) * 2 > slots.size())
+            grow();
+        size_t i = probe(key);
+        if (slots[i].list < 0)
+        {
+            slots[i] = Slot{key, (int)lists.size()};
+            lists.emplace_back();
+        }
+        lists[slots[i].list].push_back(ticket);
+    }
+
+    void remove(PhoneKey mobile, int ticket)
+    {
+        vector<int> *list = listFor(mobile.packed());
+        if (!list)
+            return;
+        auto it = std::find(list->begin(), list->end(), ticket);
+        if (it != list->end())
+        {
+            *it = list->back();
+            list->pop_back();
+        }
+    }
+
+    // Positions of every ticket booked with this mobile number
+    const vector<int> &find(PhoneKey mobile) const
+    {
+        static const vector<int> none;
+        if (slots.empty())
+            return none;
+        size_t i = probe(mobile.packed());
+        return slots[i].list >= 0 ? lists[slots[i].list] : none;
+    }
+};
+
+// Pushes everything written to a file through to the disk
+bool flushToDisk(FILE *file)
+{
+    if (fflush(file) != 0)
+        return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fdatasync(fileno(file)) == 0;
+#endif
+}
+
+// Append-only write-ahead journal of movies added, bookings and cancellations.
+// Each record is [body size][FNV-1a of body][body], and the body starts with a
+// sequence number. Text fields carry a 32-bit length, so no name can overflow
+// its frame. Callers append() a record and later sync() to its sequence
+// number before reporting success. Concurrent sync() calls are grouped: one
+// caller writes out everything pending with a single fdatasync while the others
+// wait for it, so durability costs one disk flush per group, not per booking.
+class Journal
+{
+public:
+    enum RecordType : uint8_t
+    {
+        MovieAdded = 1,
+        Booked = 2,
+        Cancelled = 3
+    };
+
+    struct Record
+    {
+        uint64_t sequence;
+        RecordType type;
+        string_view name, title, timing; // Views into the journal being replayed
+        PhoneKey mobile;
+        double price;
+        int seatCount;
+        vector<int> seats;
+    };
+
+private:
+    FILE *file = nullptr;
+    mutex lock;
+    condition_variable flushed;
+    string pending, writing;   // Records not yet handed to the disk, and the group being written
+    uint64_t lastSequence = 0; // Last sequence number handed out
+    uint64_t durable = 0;      // Everything up to here is on disk
+    bool flushing = false, failed = false;
+    size_t syncCount = 0;
+    string openError; // Why open() failed
+
+    static uint32_t checksum(const char *data, size_t size)
+    {
+        uint32_t h = 2166136261u; // FNV-1a
+        for (size_t i = 0; i < size; i++)
+            h = (h ^ (unsigned char)data[i]) * 16777619u;
+        return h;
+    }
+
+    template <typename T>
+    static void put(string &out, T value) { out.append((const char *)&value, sizeof(value)); }
+
+    static void putText(string &out, string_view text)
+    {
+        put<uint32_t>(out, text.size());
+        out.append(text);
+    }
+
+    static void putSeats(string &out, const vector<int> &seats)
+    {
+        put<uint32_t>(out, seats.size());
+        for (int seat : seats)
+            put<int32_t>(out, seat);
+    }
+
+    // Reads fields back out of a body, failing on anything that runs past it
+    struct Reader
+    {
+        const char *at, *end;
+
+        template <typename T>
+        bool get(T &value)
+        {
+            if (size_t(end - at) < sizeof(T))
+                return false;
+            memcpy(&value, at, sizeof(T));
+            at += sizeof(T);
+            return true;
+        }
+
+        bool getText(string_view &text)
+        {
+            uint32_t size;
+            if (!get(size) || size_t(end - at) < size)
+                return false;
+            text = string_view(at, size);
+            at += size;
+            return true;
+        }
+
+        bool getSeats(vector<int> &seats)
+        {
+            uint32_t count;
+            if (!get(count) || size_t(end - at) / sizeof(int32_t) < count)
+                return false;
+            seats.resize(count);
+            memcpy(seats.data(), at, count * sizeof(int32_t));
+            at += count * sizeof(int32_t);
+            return true;
+        }
+    };
+
+    static bool decode(const char *body, size_t size, Record &record)
+    {
+        Reader in{body, body + size};
+        uint8_t type;
+        if (!in.get(record.sequence) || !in.get(type))
+            return false;
+        record.type = RecordType(type);
+        uint64_t mobile;
+        switch (record.type)
+        {
+        case MovieAdded:
+            return in.getText(record.title) && in.getText(record.timing) && in.get(record.price) &&
+                   in.get(record.seatCount) && in.at == in.end;
+        case Booked:
+            if (!in.getText(record.name) || !in.get(mobile) || !in.getText(record.title) || !in.getText(record.timing) ||
+                !in.getSeats(record.seats))
+                return false;
+            record.mobile = PhoneKey::fromPacked(mobile);
+            return in.at == in.end;
+        case Cancelled:
+            if (!in.getText(record.name) || !in.get(mobile) || !in.getText(record.title) || !in.getText(record.timing) ||
+                !in.getSeats(record.seats))
+                return false;
+            record.mobile = PhoneKey::fromPacked(mobile);
+            return in.at == in.end;
+        }
+        return false;
+    }
+
+    // True if an intact record starts anywhere in text after `from`: damage
+    // with a good record behind it is corruption, not a torn tail
+    static bool recordAfter(const string &text, size_t from)
+    {
+        Record record;
+        for (size_t at = from + 1; at < text.size() && text.size() - at >= 8; at++)
+        {
+            uint32_t size, sum;
+            memcpy(&size, text.data() + at, 4);
+            memcpy(&sum, text.data() + at + 4, 4);
+            if (text.size() - at - 8 >= size && checksum(text.data() + at + 8, size) == sum &&
+                decode(text.data() + at + 8, size, record))
+                return true;
+        }
+        return false;
+    }
+
+    // Frames a body that starts with the next sequence number; lock is held
+    uint64_t appendBody(string &body)
+    {
+        uint32_t size = body.size();
+        uint32_t sum = checksum(body.data(), body.size());
+        put(pending, size);
+        put(pending, sum);
+        pending += body;
+        return lastSequence;
+    }
+
+    string startBody(RecordType type)
+    {
+        string body;
+        put(body, ++lastSequence);
+        put<uint8_t>(body, type);
+        return body;
+    }
+
+public:
+    Journal() = default;
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    ~Journal()
+    {
+        if (file)
+        {
+            sync(lastSequence);
+            fclose(file);
+        }
+    }
+
+    // Opens or creates the journal at path, hands every intact record to
+    // replay in order, and cuts off a torn last record left by a crash
+    // mid-write. A damaged record with more after it is corruption, not a torn
+    // write: open() then fails and leaves the file alone. New records are
+    // numbered after both the journal and `after` (the sequence a snapshot
+    // already covers).
+    template <typename F>
+    bool open(const string &path, uint64_t after, F replay)
+    {
+        string text;
+        if (FILE *in = fopen(path.c_str(), "rb"))
+        {
+            char buffer[1 << 16];
+            size_t n;
+            while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+                text.append(buffer, n);
+            fclose(in);
+        }
+        size_t good = 0;
+        Record record;
+        while (text.size() - good >= 8)
+        {
+            uint32_t size, sum;
+            memcpy(&size, text.data() + good, 4);
+            memcpy(&sum, text.data() + good + 4, 4);
+            const char *body = text.data() + good + 8;
+            if (text.size() - good - 8 < size)
+            {
+                if (!recordAfter(text, good))
+                    break; // Runs past the end of the file with nothing after it: torn
+                openError = "bad record length at offset " + to_string(good);
+                return false;
+            }
+            bool last = good + 8 + size == text.size();
+            if (checksum(body, size) != sum)
+            {
+                if (last)
+                    break; // The final record was only partly written
+                openError = "bad checksum at offset " + to_string(good);
+                return false;
+            }
+            if (!decode(body, size, record))
+            {
+                openError = "undecodable record at offset " + to_string(good);
+                return false;
+            }
+            replay(record);
+            lastSequence = max(lastSequence, record.sequence);
+            good += 8 + size;
+        }
+        lastSequence = max(lastSequence, after);
+        durable = lastSequence;
+
+        // Cut the torn tail off in place, then append from there
+        file = fopen(path.c_str(), "ab");
+        if (!file)
+        {
+            openError = strerror(errno);
+            return false;
+        }
+        if (good != text.size())
+        {
+#ifdef _WIN32
+            bool cut = _chsize(_fileno(file), long(good)) == 0;
+#else
+            bool cut = ftruncate(fileno(file), off_t(good)) == 0;
+#endif
+            if (!cut || !flushToDisk(file))
+            {
+                openError = "cannot cut the torn tail at offset " + to_string(good);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+    const string &error() const { return openError; }
+
+    uint64_t appendMovie(string_view title, string_view timing, double price, int seatCount)
+    {
+        lock_guard<mutex> guard(lock);
+        string body = startBody(MovieAdded);
+        putText(body, title);
+        putText(body, timing);
+        put(body, price);
+        put<int32_t>(body, seatCount);
+        return appendBody(body);
+    }
+
+    uint64_t appendBooking(string_view name, PhoneKey mobile, string_view title, string_view timing, const vector<int> &seats)
+    {
+        lock_guard<mutex> guard(lock);
+        string body = startBody(Booked);
+        putText(body, name);
+        put(body, mobile.packed());
+        putText(body, title);
+        putText(body, timing);
+        putSeats(body, seats);
+        return appendBody(body);
+    }
+
+    uint64_t appendCancellation(string_view name, PhoneKey mobile, string_view title, string_view timing, const vector<int> &seats)
+    {
+        lock_guard<mutex> guard(lock);
+        string body = startBody(Cancelled);
+        putText(body, name);
+        put(body, mobile.packed());
+        putText(body, title);
+        putText(body, timing);
+        putSeats(body, seats);
+        return appendBody(body);
+    }
+
+    // Returns once every record up to sequence is on disk; false if a write failed
+    bool sync(uint64_t sequence)
+    {
+        unique_lock<mutex> guard(lock);
+        while (durable < sequence && !failed)
+        {
+            if (flushing)
+            {
+                flushed.wait(guard); // Someone else is writing; our record may be in their group
+                continue;
+            }
+            // Lead this group: take everything pending and write it with one flush
+            flushing = true;
+            writing.swap(pending);
+            uint64_t groupEnd = lastSequence;
+            guard.unlock();
+            bool ok = fwrite(writing.data(), 1, writing.size(), file) == writing.size() && flushToDisk(file);
+            guard.lock();
+            writing.clear();
+            flushing = false;
+            syncCount++;
+            if (ok)
+                durable = groupEnd;
+            else
+                failed = true;
+            flushed.notify_all();
+        }
+        return !failed;
+    }
+
+    uint64_t lastAppended()
+    {
+        lock_guard<mutex> guard(lock);
+        return lastSequence;
+    }
+
+    size_t syncs()
+    {
+        lock_guard<mutex> guard(lock);
+        return syncCount;
+    }
+
+    // Empties the journal once a snapshot covers everything in it
+    bool truncate()
+    {
+        lock_guard<mutex> guard(lock);
+        if (flushing || !pending.empty())
+            return false;
+        fflush(file);
+#ifdef _WIN32
+        return _chsize(_fileno(file), 0) == 0;
+#else
+        return ftruncate(fileno(file), 0) == 0;
+#endif
+    }
+};
+
+class BookingSystem
+{
+    vector<Movie> movies;
+    TicketSlotMap tickets;
+    ShowIndex showIndex;             // (title, timing) -> position in movies
+    ScheduleIndex schedule;          // Positions in movies by start time
+    CustomerTicketIndex ticketIndex; // Mobile number -> slots in tickets
+    Journal *journal = nullptr;      // Changes are appended here when set
+    uint64_t lastJournaled = 0;      // Sequence number of the latest change this state includes
+
+    void removeTicket(TicketSlotMap::Handle handle)
+    {
+        ticketIndex.remove(tickets.get(handle)->mobileNumber, TicketSlotMap::indexOf(handle));
+        tickets.erase(handle);
+    }
+
+    // Takes back a booking that could not be made durable, without journaling it
+    void undoBooking(TicketSlotMap::Handle handle)
+    {
+        Ticket *ticket = tickets.get(handle);
+        Movie *movie = getMovie(ticket->movieTitle, ticket->movieTiming);
+        for (int seat : ticket->bookedSeats)
+            movie->seats.release(seat);
+        removeTicket(handle);
+    }
+
+    void journalCancel(const Ticket &ticket, const vector<int> &seats)
+    {
+        if (journal)
+            lastJournaled = journal->appendCancellation(symbols.str(ticket.customerName), ticket.mobileNumber,
+                                                        symbols.str(ticket.movieTitle), symbols.str(ticket.movieTiming), seats);
+    }
+
+public:
+    void addMovie(string_view title, string_view timing, double price, int seatCount = 50)
+    {
+        movies.push_back(Movie(title, timing, price, seatCount));
+        showIndex.insert(movies.back().title, movies.back().timing, movies.size() - 1);
+        schedule.insert(movies.back().startMinute, movies.size() - 1);
+        if (journal)
+            lastJournaled = journal->appendMovie(title, timing, price, seatCount);
+    }
+
+    // Journals every later change; attach after replaying, so replay is not journaled again
+    void attachJournal(Journal *j) { journal = j; }
+
+    uint64_t journalSequence() const { return lastJournaled; }
+    void markJournaled(uint64_t sequence) { lastJournaled = sequence; }
+
+    // Waits until every change so far is on disk; true when there is no journal
+    bool syncJournal() { return !journal || journal->sync(lastJournaled); }
+
+    // Applies a change read back from the journal
+    void replay(const Journal::Record &record)
+    {
+        if (record.type == Journal::MovieAdded)
+        {
+            addMovie(record.title, record.timing, record.price, record.seatCount);
+        }
+        else if (record.type == Journal::Booked)
+        {
+            int position = findShow(record.title, record.timing);
+            if (position >= 0)
+                book(symbols.intern(record.name), record.mobile, position, record.seats);
+        }
+        else if (record.type == Journal::Cancelled)
+        {
+            // A seat belongs to one ticket per show, so the seats pick out the ticket
+            Symbol name = symbols.find(record.name), title = symbols.find(record.title), timing = symbols.find(record.timing);
+            for (int slot : ticketIndex.find(record.mobile))
+            {
+                TicketSlotMap::Handle handle = tickets.handleAt(slot);
+                const Ticket *ticket = tickets.get(handle);
+                if (ticket->customerName == name && ticket->movieTitle == title && ticket->movieTiming == timing &&
+                    ticket->bookedSeats.containsAll(record.seats))
+                {
+                    cancel(handle, record.seats);
+                    break;
+                }
+            }
+        }
+        lastJournaled = record.sequence;
+    }
+
+    // Lists the movies by start time
+    void showMovies()
+    {
+        schedule.forEach([this](int position)
+                         { movies[position].display(); });
+    }
+
+    Movie *getMovie(const string &title, const string &time)
+    {
+        return getMovie(symbols.find(title), symbols.find(time));
+    }
+
+    Movie *getMovie(Symbol title, Symbol time)
+    {
+        int position = showIndex.find(title, time);
+        if (position < 0)
+            return nullptr;
+        return &movies[position];
+    }
+
+    void showAvailableSeats(const string &title, const string &time)
+    {
+        Movie *movie = getMovie(title, time);
+        if (movie)
+        {
+            movie->showAvailableSeats();
+        }
+        else
+        {
+            cout << "Movie or timing not found.\n";
+        }
+    }
+
+    // Position of a show for book(), or -1
+    int findShow(string_view title, string_view time) const
+    {
+        return showIndex.find(symbols.find(title), symbols.find(time));
+    }
+
+    Movie &show(int position) { return movies[position]; }
+
+    // Claims the seats and records the ticket; none if any seat is taken
+    TicketSlotMap::Handle book(Symbol customer, PhoneKey mobile, int show, const vector<int> &seats)
+    {
+        Movie &movie = movies[show];
+        if (!movie.bookSeats(seats)) // Claims the seats only if all are available
+            return TicketSlotMap::none;
+        TicketSlotMap::Handle handle = tickets.insert(Ticket(customer, mobile, movie.title, movie.timing, seats, movie.pricePerSeat));
+        ticketIndex.insert(mobile, TicketSlotMap::indexOf(handle));
+        if (journal)
+            lastJournaled = journal->appendBooking(symbols.str(customer), mobile, symbols.str(movie.title), symbols.str(movie.timing), seats);
+        return handle;
+    }
+
+    // Gives back some or all of a ticket's seats without printing; false if the
+    // handle is stale or a seat is not on the ticket
+    bool cancel(TicketSlotMap::Handle handle, const vector<int> &seats)
+    {
+        Ticket *ticket = tickets.get(handle);
+        if (!ticket || !ticket->checkCancel(seats))
+            return false;
+        journalCancel(*ticket, seats);
+        Movie *movie = getMovie(ticket->movieTitle, ticket->movieTiming);
+        for (int seat : seats)
+            movie->seats.release(seat);
+        if (ticket->allSeatsCancel(seats))
+            removeTicket(handle);
+        else
+            ticket->removeSeats(seats, movie->pricePerSeat);
+        return true;
+    }
+
+    const Ticket *ticket(TicketSlotMap::Handle handle) const { return tickets.get(handle); }
+
+    int showCount() const { return movies.size(); }
+    size_t ticketCount() const { return tickets.size(); }
+
+    template <typename F>
+    void forEachTicket(F f) const { tickets.forEach(f); }
+
+    // Puts back a ticket from a snapshot; its seats are restored with the seat maps
+    void restoreTicket(Ticket ticket)
+    {
+        PhoneKey mobile = ticket.mobileNumber;
+        ticketIndex.insert(mobile, TicketSlotMap::indexOf(tickets.insert(std::move(ticket))));
+    }
+
+    void reserveTickets(size_t count) { tickets.reserve(count); }
+
+    void bookTicket(const string &name, PhoneKey mobile, const string &title, const string &time, const vector<int> &seats)
+    {
+        int position = findShow(title, time);
+        if (position >= 0)
+        {
+            if (movies[position].validSeat(seats))
+            {
                 cout << "Booking failed: Please Enter Valid SeatNumber.\n";
                 return;
             }
-            if (movie->checkBookSeats(seats))
+            TicketSlotMap::Handle handle = book(symbols.intern(name), mobile, position, seats);
+            if (handle != TicketSlotMap::none)
+            {
+                if (!syncJournal())
+                {
+                    undoBooking(handle);
+                    cout << "Booking failed: it could not be saved to the journal.\n";
+                    return;
+                }
+                cout << "Booking successful!\n";
+                tickets.get(handle)->display();
+            }
+            else
+            {
+                cout << "Booking failed: Some seats unavailable.\n";
+            }
+        }
+        else
+        {
+            cout << "Movie or timing not found.\n";
+        }
+    }
+
+    void cancelTicket(const string &name, PhoneKey mobile, const string &title, const vector<int> &seats)
+    {
+        TicketSlotMap::Handle handle = getTicket(name, mobile, title);
+        Ticket *ticket = tickets.get(handle);
+        if (ticket)
+        {
+            Movie *movie = getMovie(ticket->movieTitle, ticket->movieTiming);
+            if (movie)
+            {
+                if (ticket->checkCancel(seats))
+                {
+                    journalCancel(*ticket, seats);
+                    if (!syncJournal())
+                    {
+                        cout << "Cancellation failed: it could not be saved to the journal.\n";
+                        return;
+                    }
+                    if (ticket->allSeatsCancel(seats))
+                    {
+                        movie->cancelSeats(seats);
+                        removeTicket(handle);
+                    }
+                    else
+                    {
+                        movie->cancelSeats(seats);
+                        ticket->removeSeats(seats, movie->pricePerSeat);
+                    }
+                }
+                else
+                {
+                    cout << "Cancellation failed: Some seats were not booked.\n";
+                }
+            }
+            else
+            {
+                cout << "Cancellation failed: Movie not found.\n";
+            }
+        }
+        else
+        {
+            cout << "Ticket not found.\n";
+        }
+    }
+
+    // Handle of the customer's ticket for a title, or TicketSlotMap::none
+    TicketSlotMap::Handle getTicket(string_view name, PhoneKey mobile, string_view title) const
+    {
+        Symbol nameId = symbols.find(name), titleId = symbols.find(title);
+        if (nameId == SymbolTable::none || titleId == SymbolTable::none)
+            return TicketSlotMap::none; // Never interned, so no ticket can carry it
+        for (int slot : ticketIndex.find(mobile))
+        {
+            TicketSlotMap::Handle handle = tickets.handleAt(slot);
+            const Ticket *ticket = tickets.get(handle);
+            if (ticket->customerName == nameId && ticket->movieTitle == titleId)
+            {
+                return handle;
+            }
+        }
+        return TicketSlotMap::none;
+    }
+
+    void retrieveTicket(const string &name, const string &title, PhoneKey mobile)
+    {
+        const Ticket *ticket = tickets.get(getTicket(name, mobile, title));
+        if (ticket)
+        {
+            ticket->display();
+        }
+        else
+        {
+            cout << "Ticket not found.\n";
+        }
+    }
+
+    bool isValidPhoneNumber(const string &mobile)
+    {
+        return PhoneKey(mobile).valid();
+    }
+
+    void run_choice_2()
+    { // Book Ticket
+        string name, mobile, title, time;
+        int seat;
+        vector<int> seats;
+        cout << "Enter name: ";
+        cin.ignore();
+        getline(cin, name);
+        cout << "Enter mobile: ";
+        cin >> mobile;
+        while (!isValidPhoneNumber(mobile))
+        {
+            cout << "Please enter a valid phone number: ";
+            cin >> mobile;
+        }
+        cout << "Enter movie title: ";
+        cin.ignore();
+        getline(cin, title);
+        cout << "Enter movie timing: ";
+        getline(cin, time);
+
+        if (getMovie(title, time) == nullptr)
+        {
+            cout << "Movie or timing not found.\n";
+            return;
+        }
+        showAvailableSeats(title, time);
+
+        cout << "Enter seat numbers (end with -1): ";
+        while (cin >> seat && seat != -1)
+            seats.push_back(seat);
+        bookTicket(name, PhoneKey(mobile), title, time, seats);
+    }
+
+    void run_choice_3()
+    { // Cancel Ticket
+        string name, mobile, title;
+        int seat;
+        vector<int> seats;
+        cout << "Enter name: ";
+        cin.ignore();
+        getline(cin, name);
+        cout << "Enter mobile: ";
+        cin >> mobile;
+        while (!isValidPhoneNumber(mobile))
+        {
+            cout << "Please enter a valid phone number: ";
+            cin >> mobile;
+        }
+        cout << "Enter movie title: ";
+        cin.ignore();
+        getline(cin, title);
+        const Ticket *ticket = tickets.get(getTicket(name, PhoneKey(mobile), title));
+        if (ticket == nullptr)
+        {
+            cout << "Ticket not found.\n";
+            return;
+        }
+
+        ticket->displayBookedSeats();
+        cout << "Enter seat numbers to cancel (end with -1): ";
+        while (cin >> seat && seat != -1)
+            seats.push_back(seat);
+        cancelTicket(name, PhoneKey(mobile), title, seats);
+    }
+
+    void run_choice_4()
+    { // Show Available Seats
+        cout << "Enter the movie title: ";
+        string title;
+        cin.ignore();
+        getline(cin, title);
+        cout << "Enter the movie timing: ";
+        string time;
+        getline(cin, time);
+        showAvailableSeats(title, time);
+    }
+
+    void run_choice_5()
+    { // Retrieve Ticket
+        string name, mobile, title;
+        cout << "Enter name: ";
+        cin.ignore();
+        getline(cin, name);
+        cout << "Enter movie title: ";
+        getline(cin, title);
+        cout << "Enter mobile: ";
+        cin >> mobile;
+        retrieveTicket(name, title, PhoneKey(mobile));
+    }
+};
+
+// Binary snapshot of the catalog, seat maps and tickets. Every section is an
+// array of fixed-size records at an 8-byte aligned offset named in the header,
+// so loading maps the file and copies sections straight into place with no
+// text to parse. Strings are stored once, as the symbol table's offsets and
+// text, and records refer to them by symbol id.
+//
+//   Header (including the journal sequence the snapshot covers)
+//   uint32 string offsets[stringCount + 1], then the string text
+//   SnapshotMovie[movieCount], then uint64 seat words (bit set = free)
+//   SnapshotTicket[ticketCount], then int32 ticket seats
+class Snapshot
+{
+public:
+    static constexpr char magic[8] = {'M', 'O', 'V', 'S', 'N', 'A', 'P', 0};
+    static const uint32_t version = 2;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t stringCount, movieCount, seatWordCount, ticketCount, ticketSeatCount;
+        uint64_t stringOffsetsAt, stringTextAt, moviesAt, seatWordsAt, ticketsAt, ticketSeatsAt, fileSize;
+        uint64_t journalSequence; // Journal records up to here are already included
+    };
+
+    struct MovieRecord
+    {
+        uint32_t title, timing;
+        double price;
+        int32_t seatCount;
+        uint32_t wordCount;
+        uint64_t firstWord; // Index into the seat words
+    };
+
+    struct TicketRecord
+    {
+        uint32_t name, title, timing, seatCount;
+        uint64_t mobile;
+        double totalPrice;
+        uint64_t firstSeat; // Index into the ticket seats
+    };
+
+    static uint64_t align8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+    // The whole file as bytes. Runs on the booking thread and only copies;
+    // writing to disk happens elsewhere. The copy is of the whole state, not
+    // incremental or copy-on-write, so the pause grows with it: about 80-110 ms
+    // at 50,000 shows and a million tickets (see --snapshot-bench), during
+    // which --serve answers nothing.
+    static vector<char> capture(BookingSystem &system)
+    {
+        Header header = {};
+        memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.headerSize = sizeof(Header);
+        header.journalSequence = system.journalSequence();
+        header.stringCount = symbols.size();
+        header.movieCount = system.showCount();
+        uint64_t textBytes = 0;
+        for (Symbol id = 0; id < header.stringCount; id++)
+            textBytes += symbols.str(id).size();
+        for (int show = 0; show < system.showCount(); show++)
+            header.seatWordCount += system.show(show).seats.wordSize();
+        header.ticketCount = system.ticketCount();
+        system.forEachTicket([&](const Ticket &ticket)
+                             { header.ticketSeatCount += ticket.bookedSeats.size(); });
+
+        header.stringOffsetsAt = align8(sizeof(Header));
+        header.stringTextAt = header.stringOffsetsAt + (header.stringCount + 1) * sizeof(uint32_t);
+        header.moviesAt = align8(header.stringTextAt + textBytes);
+        header.seatWordsAt = header.moviesAt + header.movieCount * sizeof(MovieRecord);
+        header.ticketsAt = header.seatWordsAt + header.seatWordCount * sizeof(uint64_t);
+        header.ticketSeatsAt = header.ticketsAt + header.ticketCount * sizeof(TicketRecord);
+        header.fileSize = align8(header.ticketSeatsAt + header.ticketSeatCount * sizeof(int32_t));
+
+        vector<char> image(header.fileSize);
+        char *base = image.data();
+        memcpy(base, &header, sizeof(header));
+
+        uint32_t *offsets = (uint32_t *)(base + header.stringOffsetsAt);
+        char *text = base + header.stringTextAt;
+        uint32_t offset = 0;
+        for (Symbol id = 0; id < header.stringCount; id++)
+        {
+            const string &str = symbols.str(id);
+            offsets[id] = offset;
+            memcpy(text + offset, str.data(), str.size());
+            offset += str.size();
+        }
+        offsets[header.stringCount] = offset;
+
+        MovieRecord *movieRecords = (MovieRecord *)(base + header.moviesAt);
+        uint64_t *seatWords = (uint64_t *)(base + header.seatWordsAt);
+        uint64_t word = 0;
+        for (int show = 0; show < system.showCount(); show++)
+        {
+            const Movie &movie = system.show(show);
+            movieRecords[show] = MovieRecord{movie.title, movie.timing, movie.pricePerSeat, movie.seats.size(),
+                                             uint32_t(movie.seats.wordSize()), word};
+            movie.seats.copyWords(seatWords + word);
+            word += movie.seats.wordSize();
+        }
+
+        TicketRecord *ticketRecords = (TicketRecord *)(base + header.ticketsAt);
+        int32_t *ticketSeats = (int32_t *)(base + header.ticketSeatsAt);
+        uint64_t ticketIndex = 0, seat = 0;
+        system.forEachTicket([&](const Ticket &ticket)
+                             {
+            ticketRecords[ticketIndex++] = TicketRecord{ticket.customerName, ticket.movieTitle, ticket.movieTiming,
+                                                        uint32_t(ticket.bookedSeats.size()), ticket.mobileNumber.packed(),
+                                                        ticket.totalPrice, seat};
+            for (int s : ticket.bookedSeats)
+                ticketSeats[seat++] = s; });
+        return image;
+    }
+
+    // Writes next to path and renames over it, so a reader never sees half a file
+    static bool write(const vector<char> &image, const string &path)
+    {
+        string temporary = path + ".tmp";
+        FILE *out = fopen(temporary.c_str(), "wb");
+        if (!out)
+            return false;
+        bool ok = fwrite(image.data(), 1, image.size(), out) == image.size() && flushToDisk(out);
+        ok = fclose(out) == 0 && ok;
+#ifdef _WIN32
+        remove(path.c_str()); // rename() does not replace an existing file here
+#endif
+        return ok && rename(temporary.c_str(), path.c_str()) == 0;
+    }
+
+    // A read-only view of a whole file: mmap where there is one, otherwise read
+    // into memory
+    class MappedFile
+    {
+    private:
+        const char *bytes = nullptr;
+        size_t length = 0;
+        vector<char> copy;
+
+    public:
+        MappedFile(const string &path)
+        {
+#ifndef _WIN32
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size > 0)
+            {
+                void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (map != MAP_FAILED)
+                {
+                    bytes = (const char *)map;
+                    length = info.st_size;
+                }
+            }
+            close(fd);
+#else
+            FILE *in = fopen(path.c_str(), "rb");
+            if (!in)
+                return;
+            char buffer[1 << 16];
+            size_t n;
+            while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+                copy.insert(copy.end(), buffer, buffer + n);
+            fclose(in);
+            bytes = copy.data();
+            length = copy.size();
+#endif
+        }
+
+        ~MappedFile()
+        {
+#ifndef _WIN32
+            if (bytes)
+                munmap((void *)bytes, length);
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const char *data() const { return bytes; }
+        size_t size() const { return length; }
+    };
+
+    // Rebuilds an empty BookingSystem from a snapshot; false (with the system
+    // untouched) if the file is missing, from another version or inconsistent
+    static bool load(const string &path, BookingSystem &system)
+    {
+        MappedFile file(path);
+        if (!file.data() || file.size() < sizeof(Header))
+            return false;
+        const char *base = file.data();
+        Header header;
+        memcpy(&header, base, sizeof(header));
+        if (memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version ||
+            header.headerSize != sizeof(Header) || header.fileSize != file.size())
+            return false;
+        auto inside = [&](uint64_t at, uint64_t count, uint64_t size)
+        { return at % 8 == 0 && at <= file.size() && count <= (file.size() - at) / size; };
+        if (!inside(header.stringOffsetsAt, header.stringCount + 1, sizeof(uint32_t)) ||
+            !inside(header.moviesAt, header.movieCount, sizeof(MovieRecord)) ||
+            !inside(header.seatWordsAt, header.seatWordCount, sizeof(uint64_t)) ||
+            !inside(header.ticketsAt, header.ticketCount, sizeof(TicketRecord)) ||
+            !inside(header.ticketSeatsAt, header.ticketSeatCount, sizeof(int32_t)))
+            return false;
+
+        const uint32_t *offsets = (const uint32_t *)(base + header.stringOffsetsAt);
+        const char *text = base + header.stringTextAt;
+        if (header.stringTextAt + offsets[header.stringCount] > file.size())
+            return false;
+        auto textOf = [&](uint32_t id)
+        { return string_view(text + offsets[id], offsets[id + 1] - offsets[id]); };
+        for (Symbol id = 0; id < header.stringCount; id++)
+        {
+            if (offsets[id] > offsets[id + 1])
+                return false;
+        }
+
+        const MovieRecord *movieRecords = (const MovieRecord *)(base + header.moviesAt);
+        const uint64_t *seatWords = (const uint64_t *)(base + header.seatWordsAt);
+        for (uint64_t i = 0; i < header.movieCount; i++)
+        {
+            const MovieRecord &record = movieRecords[i];
+            if (record.title >= header.stringCount || record.timing >= header.stringCount || record.seatCount < 1 ||
+                record.wordCount != uint32_t((record.seatCount + 63) / 64) || record.firstWord + record.wordCount > header.seatWordCount)
+                return false;
+        }
+        // Shows grouped by title id in the file: those of title t are
+        // titleShows[titleStart[t] .. titleStart[t + 1])
+        vector<uint32_t> titleStart(header.stringCount + 1, 0), titleShows(header.movieCount);
+        for (uint64_t i = 0; i < header.movieCount; i++)
+            titleStart[movieRecords[i].title + 1]++;
+        for (uint64_t t = 0; t < header.stringCount; t++)
+            titleStart[t + 1] += titleStart[t];
+        vector<uint32_t> next(titleStart.begin(), titleStart.end() - 1);
+        for (uint64_t i = 0; i < header.movieCount; i++)
+            titleShows[next[movieRecords[i].title]++] = uint32_t(i);
+        const TicketRecord *ticketRecords = (const TicketRecord *)(base + header.ticketsAt);
+        const int32_t *ticketSeats = (const int32_t *)(base + header.ticketSeatsAt);
+        for (uint64_t i = 0; i < header.ticketCount; i++)
+        {
+            const TicketRecord &record = ticketRecords[i];
+            if (record.name >= header.stringCount || record.title >= header.stringCount || record.timing >= header.stringCount ||
+                record.seatCount > header.ticketSeatCount || record.firstSeat > header.ticketSeatCount - record.seatCount)
+                return false;
+            // Every seat must exist in a show of this file
+            int32_t seatCount = 0;
+            for (uint32_t j = titleStart[record.title]; j < titleStart[record.title + 1]; j++)
+            {
+                if (movieRecords[titleShows[j]].timing == record.timing)
+                    seatCount = movieRecords[titleShows[j]].seatCount;
+            }
+            if (seatCount == 0)
+                return false; // No such show
+            for (uint64_t s = record.firstSeat; s < record.firstSeat + record.seatCount; s++)
             {
-                movie->bookSeats(seats);
-                tickets.push_back(Ticket(name, mobile, title, time, seats, movie->pricePerSeat));
-                cout << "Booking successful!\n";
-                tickets.back().display();
+                if (ticketSeats[s] < 1 || ticketSeats[s] > seatCount)
+                    return false;
+            }
+        }
+
+        // Everything checks out: only now touch the symbol table and the system
+        vector<Symbol> remap(header.stringCount); // Ids in the file -> ids in this process
+        for (Symbol id = 0; id < header.stringCount; id++)
+            remap[id] = symbols.intern(textOf(id));
+        for (uint64_t i = 0; i < header.movieCount; i++)
+        {
+            const MovieRecord &record = movieRecords[i];
+            system.addMovie(textOf(record.title), textOf(record.timing), record.price, record.seatCount);
+            system.show(system.showCount() - 1).seats.loadWords(seatWords + record.firstWord);
+        }
+        system.reserveTickets(header.ticketCount);
+        vector<int> seats;
+        for (uint64_t i = 0; i < header.ticketCount; i++)
+        {
+            const TicketRecord &record = ticketRecords[i];
+            seats.assign(ticketSeats + record.firstSeat, ticketSeats + record.firstSeat + record.seatCount);
+            Ticket ticket(remap[record.name], PhoneKey::fromPacked(record.mobile), remap[record.title], remap[record.timing], seats, 0.0);
+            ticket.totalPrice = record.totalPrice;
+            system.restoreTicket(std::move(ticket));
+        }
+        system.markJournaled(header.journalSequence);
+        return true;
+    }
+};
+
+// Writes snapshots on a background thread. start() takes the copy on the
+// caller's thread and returns; bookings carry on while the file is written,
+// but not while the copy is taken (see Snapshot::capture).
+class SnapshotWriter
+{
+private:
+    thread worker;
+    bool lastOk = true;
+
+public:
+    ~SnapshotWriter() { wait(); }
+
+    void start(BookingSystem &system, const string &path)
+    {
+        wait(); // One snapshot in flight at a time
+        vector<char> image = Snapshot::capture(system);
+        worker = thread([this, image = std::move(image), path]()
+                        { lastOk = Snapshot::write(image, path); });
+    }
+
+    // Waits for the snapshot in flight; false if writing it failed
+    bool wait()
+    {
+        if (worker.joinable())
+            worker.join();
+        return lastOk;
+    }
+};
+
+// Bookings spread over worker threads, one BookingSystem (shard) per thread.
+// Shows are dealt out round robin, so show id g lives on shard g % N at
+// position g / N, and each shard owns the seat maps and tickets of its shows.
+// Requests reach the owning shard through its queue and are answered through
+// the sender's reply queue; operations on shows of different shards share no
+// data and no lock.
+//
+// Shows are added before start(). The global symbol table is not thread-safe,
+// so requests carry interned ids and the shards never intern. Shards keep no
+// journal.
+class ShardedBookingSystem
+{
+public:
+    enum Operation : uint8_t
+    {
+        Book,
+        Cancel
+    };
+
+    static constexpr int maxSeats = 8; // Seats per request
+
+    class ReplyQueue;
+
+    struct Request
+    {
+        Operation operation;
+        uint8_t seatCount;             // At most maxSeats, or the request is refused
+        int show;                      // Global show id
+        Symbol customer;
+        PhoneKey mobile;
+        TicketSlotMap::Handle ticket;  // The ticket to cancel seats from
+        uint64_t tag;                  // Handed back in the reply
+        ReplyQueue *replyTo;
+        int seats[maxSeats];
+    };
+
+    struct Reply
+    {
+        uint64_t tag;
+        bool ok;
+        TicketSlotMap::Handle ticket; // Booked ticket, valid on the show's shard
+    };
+
+    // Replies to one sender, delivered a batch at a time
+    class ReplyQueue
+    {
+        mutex lock;
+        condition_variable arrived;
+        vector<Reply> replies;
+
+    public:
+        void push(const Reply *first, size_t count)
+        {
+            lock_guard<mutex> guard(lock);
+            replies.insert(replies.end(), first, first + count);
+            arrived.notify_one(); // Under the lock: once the last reply is seen, the sender may destroy the queue
+        }
+
+        // Swaps out everything that has arrived, waiting for something if asked
+        void take(vector<Reply> &out, bool wait)
+        {
+            out.clear();
+            unique_lock<mutex> guard(lock);
+            if (wait)
+                arrived.wait(guard, [this]()
+                             { return !replies.empty(); });
+            out.swap(replies);
+        }
+    };
+
+private:
+    // Each shard is its own allocation, aligned so no two share a cache line
+    struct alignas(64) Shard
+    {
+        BookingSystem system;
+        mutex lock;
+        condition_variable wake;
+        vector<Request> queue; // Guarded by lock
+        bool stopping = false;
+        thread worker;
+        size_t served = 0; // Requests handled, read after stop
+    };
+
+    vector<unique_ptr<Shard>> shards;
+    int shows = 0;
+
+    void serve(Shard &shard)
+    {
+        vector<Request> batch;
+        vector<Reply> replies;
+        vector<int> seats;
+        while (true)
+        {
+            {
+                unique_lock<mutex> guard(shard.lock);
+                shard.wake.wait(guard, [&]()
+                                { return shard.stopping || !shard.queue.empty(); });
+                if (shard.queue.empty())
+                    return; // Stopping, with nothing left to do
+                batch.swap(shard.queue);
+            }
+            // Answer in runs of requests from the same sender, one push each
+            for (size_t i = 0; i < batch.size(); i++)
+            {
+                const Request &request = batch[i];
+                Reply reply = {request.tag, false, TicketSlotMap::none};
+                seats.assign(request.seats, request.seats + min<int>(request.seatCount, maxSeats));
+                if (request.seatCount > maxSeats)
+                    reply.ok = false; // More seats than a request holds
+                else if (request.operation == Book)
+                {
+                    int position = request.show / int(shards.size());
+                    if (!shard.system.show(position).validSeat(seats))
+                        reply.ticket = shard.system.book(request.customer, request.mobile, position, seats);
+                    reply.ok = reply.ticket != TicketSlotMap::none;
+                }
+                else
+                {
+                    reply.ok = shard.system.cancel(request.ticket, seats);
+                    reply.ticket = request.ticket;
+                }
+                replies.push_back(reply);
+                if (i + 1 == batch.size() || batch[i + 1].replyTo != request.replyTo)
+                {
+                    request.replyTo->push(replies.data(), replies.size());
+                    replies.clear();
+                }
+            }
+            shard.served += batch.size();
+            batch.clear();
+        }
+    }
+
+public:
+    // Requests from one thread, batched per shard before they are queued
+    class Session
+    {
+        ShardedBookingSystem &engine;
+        vector<vector<Request>> outgoing; // Per shard
+        size_t batchSize;
+
+    public:
+        ReplyQueue replies;
+
+        Session(ShardedBookingSystem &engine, size_t batchSize = 64)
+            : engine(engine), outgoing(engine.shardCount()), batchSize(batchSize) {}
+
+        void send(Request request)
+        {
+            request.replyTo = &replies;
+            int shard = engine.shardOf(request.show);
+            outgoing[shard].push_back(request);
+            if (outgoing[shard].size() >= batchSize)
+                engine.enqueue(shard, outgoing[shard]);
+        }
+
+        // Queues whatever is still batched
+        void flush()
+        {
+            for (size_t shard = 0; shard < outgoing.size(); shard++)
+            {
+                if (!outgoing[shard].empty())
+                    engine.enqueue(shard, outgoing[shard]);
+            }
+        }
+    };
+
+    ShardedBookingSystem(int shardCount)
+    {
+        for (int i = 0; i < shardCount; i++)
+            shards.emplace_back(new Shard());
+    }
+
+    ~ShardedBookingSystem()
+    {
+        for (auto &shard : shards)
+        {
+            {
+                lock_guard<mutex> guard(shard->lock);
+                shard->stopping = true;
             }
+            shard->wake.notify_one();
+        }
+        for (auto &shard : shards)
+        {
+            if (shard->worker.joinable())
+                shard->worker.join();
+        }
+    }
+
+    int shardCount() const { return shards.size(); }
+    int shardOf(int show) const { return show % int(shards.size()); }
+
+    // Adds a show to its shard and returns its global id; only before start()
+    int addMovie(string_view title, string_view timing, double price, int seatCount = 50)
+    {
+        shards[shardOf(shows)]->system.addMovie(title, timing, price, seatCount);
+        return shows++;
+    }
+
+    // Global id of a show, or -1
+    int findShow(string_view title, string_view timing) const
+    {
+        for (size_t shard = 0; shard < shards.size(); shard++)
+        {
+            int position = shards[shard]->system.findShow(title, timing);
+            if (position >= 0)
+                return position * int(shards.size()) + shard;
+        }
+        return -1;
+    }
+
+    void start()
+    {
+        for (auto &shard : shards)
+        {
+            Shard *owner = shard.get();
+            owner->worker = thread([this, owner]()
+                                   { serve(*owner); });
+        }
+    }
+
+    // Moves a batch of requests onto a shard's queue, waking its worker if idle
+    void enqueue(int index, vector<Request> &batch)
+    {
+        Shard &shard = *shards[index];
+        bool wasEmpty;
+        {
+            lock_guard<mutex> guard(shard.lock);
+            wasEmpty = shard.queue.empty();
+            if (wasEmpty)
+                shard.queue.swap(batch);
             else
+                shard.queue.insert(shard.queue.end(), batch.begin(), batch.end());
+        }
+        batch.clear();
+        if (wasEmpty)
+            shard.wake.notify_one();
+    }
+
+    // Tickets across every shard; only once the workers are idle
+    size_t ticketCount() const
+    {
+        size_t count = 0;
+        for (auto &shard : shards)
+            count += shard->system.ticketCount();
+        return count;
+    }
+};
+
+// Batch mode (run with --batch [file]): replays a command file with no prompts.
+// The whole file is read up front and results are collected in one buffer that
+// is written out in large blocks, so millions of commands can be replayed for
+// capacity tests. One command per line, fields separated by '|':
+//
+//   MOVIE|title|timing|price[|seat count]
+//   BOOK|name|mobile|title|timing|seat seat ...
+//   CANCEL|name|mobile|title|seat seat ...
+//   QUERY|name|mobile|title
+//   SEATS|title|timing
+//   SNAPSHOT|path            (copied in place, then written in the background)
+//
+// Blank lines and lines starting with '#' are skipped. Every command writes one
+// line: "OK ..." or "ERR <line>: <reason>". The socket server (--serve) speaks
+// the same protocol, with <line> counting requests on the connection.
+class BatchRunner
+{
+    BookingSystem &system;
+    string out;
+    vector<string_view> fields;
+    vector<int> seats;
+    SnapshotWriter snapshots;
+    size_t commands = 0, failures = 0;
+
+    static const size_t flushSize = 1 << 20;
+
+    static void split(string_view line, vector<string_view> &fields)
+    {
+        fields.clear();
+        size_t start = 0;
+        for (size_t i = 0; i <= line.size(); i++)
+        {
+            if (i == line.size() || line[i] == '|')
             {
-                cout << "Booking failed: Some seats unavailable.\n";
+                fields.push_back(line.substr(start, i - start));
+                start = i + 1;
+            }
+        }
+    }
+
+    static bool parseSeats(string_view text, vector<int> &seats)
+    {
+        seats.clear();
+        const char *p = text.data(), *end = text.data() + text.size();
+        while (p < end)
+        {
+            if (*p == ' ')
+            {
+                p++;
+                continue;
+            }
+            int seat;
+            auto [next, error] = from_chars(p, end, seat);
+            if (error != errc() || (next < end && *next != ' '))
+                return false;
+            seats.push_back(seat);
+            p = next;
+        }
+        return !seats.empty();
+    }
+
+    template <typename T>
+    static bool parseNumber(string_view text, T &value)
+    {
+        auto [next, error] = from_chars(text.data(), text.data() + text.size(), value);
+        return error == errc() && next == text.data() + text.size();
+    }
+
+    void appendPrice(double price)
+    {
+        char buffer[32];
+        int length = snprintf(buffer, sizeof(buffer), "%.2f", price);
+        out.append(buffer, length);
+    }
+
+    void fail(size_t lineNumber, const char *reason)
+    {
+        failures++;
+        out += "ERR ";
+        out += to_string(lineNumber);
+        out += ": ";
+        out += reason;
+        out += '\n';
+    }
+
+    void flush(bool force)
+    {
+        if (out.size() >= flushSize || (force && !out.empty()))
+        {
+            if (!system.syncJournal()) // Results are reported only once they are durable
+            {
+                cerr << "Journal write failed\n";
+                exit(1);
+            }
+            fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        }
+    }
+
+    void run(string_view line, size_t lineNumber)
+    {
+        split(line, fields);
+        string_view command = fields[0];
+        if (command == "MOVIE" && (fields.size() == 4 || fields.size() == 5))
+        {
+            double price;
+            int seatCount = 50;
+            if (!parseNumber(fields[3], price) || (fields.size() == 5 && (!parseNumber(fields[4], seatCount) || seatCount < 1)))
+                return fail(lineNumber, "bad price or seat count");
+            if (system.findShow(fields[1], fields[2]) >= 0)
+                return fail(lineNumber, "show already exists");
+            system.addMovie(fields[1], fields[2], price, seatCount);
+            out += "OK\n";
+        }
+        else if (command == "BOOK" && fields.size() == 6)
+        {
+            PhoneKey mobile(fields[2]);
+            if (!mobile.valid())
+                return fail(lineNumber, "invalid mobile");
+            int show = system.findShow(fields[3], fields[4]);
+            if (show < 0)
+                return fail(lineNumber, "movie or timing not found");
+            if (!parseSeats(fields[5], seats) || system.show(show).validSeat(seats))
+                return fail(lineNumber, "invalid seat number");
+            TicketSlotMap::Handle handle = system.book(symbols.intern(fields[1]), mobile, show, seats);
+            if (handle == TicketSlotMap::none)
+                return fail(lineNumber, "seats unavailable");
+            out += "OK ";
+            appendPrice(system.ticket(handle)->totalPrice);
+            out += '\n';
+        }
+        else if (command == "CANCEL" && fields.size() == 5)
+        {
+            PhoneKey mobile(fields[2]);
+            TicketSlotMap::Handle handle = system.getTicket(fields[1], mobile, fields[3]);
+            if (handle == TicketSlotMap::none)
+                return fail(lineNumber, "ticket not found");
+            if (!parseSeats(fields[4], seats) || !system.cancel(handle, seats))
+                return fail(lineNumber, "some seats were not booked");
+            const Ticket *ticket = system.ticket(handle);
+            out += "OK ";
+            appendPrice(ticket ? ticket->totalPrice : 0.0); // 0.00 once every seat is gone
+            out += '\n';
+        }
+        else if (command == "QUERY" && fields.size() == 4)
+        {
+            const Ticket *ticket = system.ticket(system.getTicket(fields[1], PhoneKey(fields[2]), fields[3]));
+            if (!ticket)
+                return fail(lineNumber, "ticket not found");
+            out += "OK ";
+            out += symbols.str(ticket->movieTiming);
+            out += '|';
+            for (int seat : ticket->bookedSeats)
+            {
+                out += to_string(seat);
+                out += ' ';
             }
+            out += '|';
+            appendPrice(ticket->totalPrice);
+            out += '\n';
+        }
+        else if (command == "SEATS" && fields.size() == 3)
+        {
+            int show = system.findShow(fields[1], fields[2]);
+            if (show < 0)
+                return fail(lineNumber, "movie or timing not found");
+            out += "OK ";
+            out += to_string(system.show(show).seats.freeCount());
+            out += '\n';
+        }
+        else if (command == "SNAPSHOT" && fields.size() == 2 && !fields[1].empty())
+        {
+            if (!snapshots.wait())
+                return fail(lineNumber, "previous snapshot failed");
+            snapshots.start(system, string(fields[1]));
+            out += "OK\n";
+        }
+        else
+        {
+            fail(lineNumber, "unknown command or wrong field count");
+        }
+    }
+
+public:
+    BatchRunner(BookingSystem &system) : system(system) {}
+
+    // Runs every command in text and writes the results to stdout
+    void runAll(string_view text)
+    {
+        size_t lineNumber = 0;
+        while (!text.empty())
+        {
+            size_t end = text.find('\n');
+            string_view line = text.substr(0, end);
+            text.remove_prefix(end == string_view::npos ? text.size() : end + 1);
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            if (line.empty() || line[0] == '#')
+                continue;
+            commands++;
+            run(line, lineNumber);
+            flush(false);
+        }
+        if (!snapshots.wait())
+            fail(lineNumber, "snapshot failed");
+        flush(true);
+    }
+
+    // Runs one command, appending its reply to `reply` instead of the batch
+    // output; the server uses this for each request on a connection
+    void runOne(string_view line, size_t number, string &reply)
+    {
+        out.swap(reply);
+        commands++;
+        run(line, number);
+        out.swap(reply);
+    }
+
+    size_t commandCount() const { return commands; }
+    size_t failureCount() const { return failures; }
+};
+
+// Snapshot benchmark (run with --snapshot-bench): 50,000 shows and a million
+// tickets are saved while bookings continue, then loaded into a fresh system
+// with an empty symbol table, as a restarted process would
+int runSnapshotBenchmark()
+{
+    const int showCount = 50000, ticketCount = 1000000, seatsPerShow = 200;
+    const char *timings[] = {"9:00 AM", "11:30 AM", "2:00 PM", "4:30 PM", "7:00 PM", "9:30 PM"};
+    const string path = "snapshot_bench.bin";
+    using Clock = chrono::steady_clock;
+    auto ms = [](Clock::time_point from)
+    { return chrono::duration<double, milli>(Clock::now() - from).count(); };
+
+    size_t savedTickets, savedFree = 0;
+    {
+        BookingSystem system;
+        for (int i = 0; i < showCount; i++)
+            system.addMovie("Feature " + to_string(i / 6), timings[i % 6], 8.0 + i % 5, seatsPerShow);
+        mt19937 rng(17);
+        vector<Symbol> customers;
+        vector<PhoneKey> mobiles;
+        for (int i = 0; i < 200000; i++)
+        {
+            customers.push_back(symbols.intern("Customer Number " + to_string(i)));
+            mobiles.push_back(PhoneKey(to_string(9000000000LL + i)));
+        }
+        vector<int> seats;
+        auto bookRandom = [&]()
+        {
+            int customer = rng() % customers.size();
+            seats.clear();
+            int first = 1 + rng() % (seatsPerShow - 3);
+            for (int s = 0, n = 1 + rng() % 3; s < n; s++)
+                seats.push_back(first + s);
+            return system.book(customers[customer], mobiles[customer], rng() % showCount, seats) != TicketSlotMap::none;
+        };
+        while (system.ticketCount() < size_t(ticketCount))
+            bookRandom();
+
+        auto start = Clock::now();
+        vector<char> image = Snapshot::capture(system);
+        double captureMs = ms(start);
+        savedTickets = system.ticketCount();
+        for (int show = 0; show < system.showCount(); show++)
+            savedFree += system.show(show).seats.freeCount();
+
+        // The writer gets its own copy; count the bookings made while it runs
+        start = Clock::now();
+        atomic<bool> written(false);
+        thread writer([&]()
+                      { Snapshot::write(image, path); written = true; });
+        int bookedDuringWrite = 0;
+        while (!written)
+            bookedDuringWrite += bookRandom();
+        writer.join();
+        double writeMs = ms(start);
+        cout << "Snapshot: " << showCount << " shows, " << savedTickets << " tickets, " << image.size() / (1 << 20)
+             << " MB; capture " << fixed << setprecision(1) << captureMs << " ms on the booking thread, write "
+             << writeMs << " ms in the background (" << bookedDuringWrite << " bookings made meanwhile)\n";
+    }
+
+    symbols = SymbolTable(); // As in a freshly started process
+    BookingSystem restored;
+    auto start = Clock::now();
+    bool loaded = Snapshot::load(path, restored);
+    double loadMs = ms(start);
+    remove(path.c_str());
+    size_t restoredFree = 0;
+    for (int show = 0; show < restored.showCount(); show++)
+        restoredFree += restored.show(show).seats.freeCount();
+    bool same = loaded && restored.ticketCount() == savedTickets && restored.showCount() == showCount && restoredFree == savedFree;
+    cout << "Restart: loaded in " << fixed << setprecision(1) << loadMs << " ms" << (same ? "" : " (MISMATCH)") << "\n";
+    return same ? 0 : 1;
+}
+
+// Journal benchmark (run with --journal-bench): 1, 16 and 256 threads each
+// commit bookings as fast as they can. Commits that arrive while a flush is in
+// progress share the next one, so the group size grows with the thread count.
+int runJournalBenchmark()
+{
+    const string path = "journal_bench.tmp";
+    const int groupSizes[] = {1, 16, 256};
+    const double seconds = 1.0;
+    for (int threads : groupSizes)
+    {
+        remove(path.c_str());
+        Journal journal;
+        if (!journal.open(path, 0, [](const Journal::Record &) {}))
+            return 1;
+        atomic<bool> stop(false);
+        atomic<size_t> commits(0);
+        vector<thread> workers;
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&, t]()
+                                 {
+                string name = "Customer Number " + to_string(t);
+                PhoneKey mobile(to_string(9000000000LL + t));
+                vector<int> seats = {1 + t % 50, 2 + t % 50};
+                while (!stop)
+                {
+                    if (!journal.sync(journal.appendBooking(name, mobile, "Interstellar", "8:00 AM", seats)))
+                        break;
+                    commits++;
+                } });
+        }
+        this_thread::sleep_for(chrono::duration<double>(seconds));
+        stop = true;
+        for (thread &worker : workers)
+            worker.join();
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Journal: " << setw(3) << threads << " committers, " << fixed << setprecision(0) << commits / elapsed
+             << " commits/s, " << setprecision(1) << double(commits) / max<size_t>(1, journal.syncs())
+             << " commits per fdatasync\n";
+    }
+    remove(path.c_str());
+    return 0;
+}
+
+// Sharding benchmark (run with --shard-bench [max threads]): for 1, 2, 4 ...
+// up to 64 threads, as many shards as threads and as many sender threads,
+// each sender booking its share of 2 million single seats spread over
+// every show
+int runShardBenchmark(int maxThreads)
+{
+    const int showCount = 4096, seatsPerShow = 1000, bookingCount = 2000000, customerCount = 1000;
+    vector<Symbol> customers;
+    for (int c = 0; c < customerCount; c++)
+        customers.push_back(symbols.intern("Shard Customer " + to_string(c)));
+    double firstRate = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        ShardedBookingSystem engine(threads);
+        for (int i = 0; i < showCount; i++)
+            engine.addMovie("Shard Show " + to_string(i), "6:00 PM", 10.0, seatsPerShow);
+        engine.start();
+
+        atomic<size_t> booked(0);
+        vector<thread> senders;
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++)
+        {
+            senders.emplace_back([&, t]()
+                                 {
+                ShardedBookingSystem::Session session(engine);
+                int first = int(int64_t(bookingCount) * t / threads), last = int(int64_t(bookingCount) * (t + 1) / threads);
+                ShardedBookingSystem::Request request = {};
+                request.operation = ShardedBookingSystem::Book;
+                request.seatCount = 1;
+                for (int k = first; k < last; k++)
+                {
+                    request.show = k % showCount; // Booking k takes seat k / showCount + 1 of its show, so none collide
+                    request.seats[0] = k / showCount + 1;
+                    request.customer = customers[k % customerCount];
+                    request.mobile = PhoneKey::fromPacked(9000000000ULL + k % customerCount);
+                    request.tag = k;
+                    session.send(request);
+                }
+                session.flush();
+                vector<ShardedBookingSystem::Reply> replies;
+                size_t answered = 0, ok = 0;
+                while (answered < size_t(last - first))
+                {
+                    session.replies.take(replies, true);
+                    answered += replies.size();
+                    for (const auto &reply : replies)
+                        ok += reply.ok;
+                }
+                booked += ok; });
+        }
+        for (thread &sender : senders)
+            sender.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double rate = bookingCount / seconds;
+        if (threads == 1)
+            firstRate = rate;
+        cout << "Shards: " << setw(2) << threads << " threads, " << fixed << setprecision(0) << rate << " bookings/s, "
+             << setprecision(2) << rate / firstRate << "x" << (booked == size_t(bookingCount) ? "" : " (BOOKINGS LOST)") << "\n";
+        if (booked != size_t(bookingCount) || engine.ticketCount() != size_t(bookingCount))
+            return 1;
+    }
+    return 0;
+}
+
+// Seat set regression check (run with --seat-check): INT32_MAX marks the empty
+// inline slots, so it must never be found on, or cancelled from, a ticket that
+// does not hold it
+int runSeatSetCheck()
+{
+    const int marker = INT32_MAX;
+    bool ok = true;
+    auto expect = [&ok](bool condition, const char *what)
+    {
+        if (!condition)
+        {
+            cout << "FAILED: " << what << "\n";
+            ok = false;
         }
-        else
+    };
+
+    SeatSet seats;
+    seats.insert(1);
+    seats.insert(2);
+    seats.insert(3);
+    expect(!seats.contains(marker), "a 3 seat set contains INT32_MAX");
+    expect(!seats.erase(marker) && seats.size() == 3 && seats.contains(3), "erasing INT32_MAX drops a real seat");
+    expect(seats.insert(marker) && seats.contains(marker) && seats.erase(marker) && seats.size() == 3,
+           "INT32_MAX cannot be held as a real seat");
+    expect(!seats.insert(0) && !seats.insert(-1) && seats.size() == 3, "a set takes a seat below 1");
+    for (int seat = 4; seat <= 9; seat++)
+        seats.insert(seat); // Spills to the bitmap
+    expect(!seats.contains(marker) && !seats.erase(marker) && seats.size() == 9, "a spilled set contains INT32_MAX");
+    expect(!seats.insert(0) && !seats.insert(-1000000) && seats.size() == 9, "a spilled set takes a seat below 1");
+
+    BookingSystem system;
+    system.addMovie("Avengers", "10:00 AM", 10.0);
+    Movie *movie = system.getMovie("Avengers", "10:00 AM");
+    TicketSlotMap::Handle ticket = system.book(symbols.intern("Ann"), PhoneKey("9876543210"), system.findShow("Avengers", "10:00 AM"), {1, 2, 3});
+    expect(!system.cancel(ticket, {marker}), "cancelling seat 2147483647 succeeds");
+    expect(system.ticket(ticket)->bookedSeats.size() == 3 && !movie->seats.isFree(3), "cancelling seat 2147483647 changes the ticket");
+
+    cout << (ok ? "Seat set check passed\n" : "Seat set check failed\n");
+    return ok ? 0 : 1;
+}
+
+#ifdef __linux__
+// Socket address from "host:port" (TCP) or a filesystem path (Unix domain)
+bool parseAddress(const string &address, sockaddr_storage &storage, socklen_t &length)
+{
+    memset(&storage, 0, sizeof(storage));
+    size_t colon = address.rfind(':');
+    if (address.find('/') == string::npos && colon != string::npos)
+    {
+        sockaddr_in &inet = (sockaddr_in &)storage;
+        inet.sin_family = AF_INET;
+        inet.sin_port = htons(atoi(address.c_str() + colon + 1));
+        length = sizeof(inet);
+        return inet_pton(AF_INET, address.substr(0, colon).c_str(), &inet.sin_addr) == 1;
+    }
+    sockaddr_un &local = (sockaddr_un &)storage;
+    if (address.size() >= sizeof(local.sun_path))
+        return false;
+    local.sun_family = AF_UNIX;
+    memcpy(local.sun_path, address.c_str(), address.size() + 1);
+    length = sizeof(local);
+    return true;
+}
+
+volatile sig_atomic_t stopServer = 0;
+
+// Booking server (run with --serve address [snapshot]): one thread runs a
+// level-triggered epoll loop over every client connection. Clients send the
+// batch-mode commands, one per line, and may pipeline as many as they like;
+// each gets one reply line, in order. Every pass of the loop runs all the
+// complete requests that arrived, syncs the journal once for all of them, and
+// only then writes the replies, so durability is group-committed across
+// clients.
+class BookingServer
+{
+private:
+    struct Connection
+    {
+        string in, out;
+        size_t sent = 0;     // Bytes of out already written
+        size_t requests = 0; // Request number, for error replies
+        bool closing = false, writing = false;
+    };
+
+    static const size_t maxPending = 1 << 20; // A request line longer than this closes the connection
+
+    BatchRunner &runner;
+    BookingSystem &system;
+    int listener = -1, poller = -1;
+    vector<unique_ptr<Connection>> connections; // Indexed by file descriptor
+    vector<int> touched;                        // Connections with new replies this pass
+    size_t accepted = 0;
+
+    void watch(int fd, bool wantWrite)
+    {
+        epoll_event event = {};
+        event.events = EPOLLIN | (wantWrite ? uint32_t(EPOLLOUT) : 0u);
+        event.data.fd = fd;
+        epoll_ctl(poller, EPOLL_CTL_MOD, fd, &event);
+    }
+
+    void acceptAll()
+    {
+        while (true)
         {
-            cout << "Movie or timing not found.\n";
+            int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return; // EAGAIN once the backlog is empty
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on Unix sockets
+            if ((size_t)fd >= connections.size())
+                connections.resize(fd + 1);
+            connections[fd].reset(new Connection());
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(poller, EPOLL_CTL_ADD, fd, &event);
+            accepted++;
         }
     }
 
-    void cancelTicket(string name, string mobile, string title, const vector<int> &seats)
+    void closeConnection(int fd)
     {
-        Ticket *ticket = getTicket(name, mobile, title);
-        if (ticket)
+        epoll_ctl(poller, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections[fd].reset();
+    }
+
+    // Reads what is there and runs every complete request line
+    void readFrom(int fd)
+    {
+        Connection &connection = *connections[fd];
+        char buffer[1 << 16];
+        while (true)
         {
-            Movie *movie = getMovie(title, ticket->movieTiming);
-            if (movie)
-            {
-                if (ticket->checkCancel(seats))
-                {
-                    if (ticket->allSeatsCancel(seats))
-                    {
-                        tickets.erase(remove(tickets.begin(), tickets.end(), *ticket), tickets.end());
-                    }
-                    else
-                    {
-                        movie->cancelSeats(seats);
-                        ticket->removeSeats(seats, movie->pricePerSeat);
-                    }
-                }
-                else
-                {
-                    cout << "Cancellation failed: Some seats were not booked.\n";
-                }
-            }
-            else
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n > 0)
             {
-                cout << "Cancellation failed: Movie not found.\n";
+                connection.in.append(buffer, n);
+                continue;
             }
+            if (n == 0 || (errno != EAGAIN && errno != EINTR))
+                connection.closing = true;
+            if (n < 0 && errno == EINTR)
+                continue;
+            break;
         }
-        else
+
+        size_t before = connection.out.size(), start = 0;
+        while (true)
         {
-            cout << "Ticket not found.\n";
+            size_t end = connection.in.find('\n', start);
+            if (end == string::npos)
+                break;
+            string_view line(connection.in.data() + start, end - start);
+            start = end + 1;
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            if (line.empty() || line[0] == '#')
+                continue;
+            runner.runOne(line, ++connection.requests, connection.out);
+        }
+        connection.in.erase(0, start);
+        if (connection.in.size() > maxPending)
+        {
+            connection.closing = true;
+            connection.in.clear();
         }
+        if (connection.out.size() != before || connection.closing)
+            touched.push_back(fd);
     }
 
-    Ticket *getTicket(const string &name, const string &mobile, const string &title)
+    // Writes as much of the pending replies as the socket takes
+    void writeTo(int fd)
     {
-        for (auto &ticket : tickets)
+        Connection &connection = *connections[fd];
+        while (connection.sent < connection.out.size())
+        {
+            ssize_t n = write(fd, connection.out.data() + connection.sent, connection.out.size() - connection.sent);
+            if (n > 0)
+                connection.sent += n;
+            else if (n < 0 && errno == EINTR)
+                continue;
+            else if (n < 0 && errno == EAGAIN)
+                break;
+            else
+            {
+                closeConnection(fd);
+                return;
+            }
+        }
+        if (connection.sent == connection.out.size())
         {
-            if (ticket.customerName == name && ticket.mobileNumber == mobile && ticket.movieTitle == title)
+            connection.out.clear();
+            connection.sent = 0;
+            if (connection.closing)
             {
-                return &ticket;
+                closeConnection(fd);
+                return;
             }
         }
-        return nullptr;
+        bool wantWrite = !connection.out.empty();
+        if (wantWrite != connection.writing)
+        {
+            connection.writing = wantWrite;
+            watch(fd, wantWrite);
+        }
     }
 
-    void retrieveTicket(const string &name, const string &title, const string &mobile)
+public:
+    BookingServer(BatchRunner &runner, BookingSystem &system) : runner(runner), system(system) {}
+
+    ~BookingServer()
     {
-        Ticket *ticket = getTicket(name, mobile, title);
-        if (ticket)
+        for (size_t fd = 0; fd < connections.size(); fd++)
         {
-            ticket->display();
+            if (connections[fd])
+                close(fd);
         }
-        else
+        if (listener >= 0)
+            close(listener);
+        if (poller >= 0)
+            close(poller);
+    }
+
+    bool listenOn(const string &address)
+    {
+        sockaddr_storage storage;
+        socklen_t length;
+        if (!parseAddress(address, storage, length))
+            return false;
+        listener = socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listener < 0)
+            return false;
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (storage.ss_family == AF_UNIX)
+            unlink(address.c_str()); // A socket file left by an earlier run
+        if (bind(listener, (sockaddr *)&storage, length) != 0 || ::listen(listener, 4096) != 0)
+            return false;
+        poller = epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = listener;
+        return poller >= 0 && epoll_ctl(poller, EPOLL_CTL_ADD, listener, &event) == 0;
+    }
+
+    // Serves until SIGINT or SIGTERM; false if the journal stops accepting writes
+    bool run()
+    {
+        epoll_event events[1024];
+        while (!stopServer)
         {
-            cout << "Ticket not found.\n";
+            int count = epoll_wait(poller, events, 1024, -1);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            touched.clear();
+            for (int i = 0; i < count; i++)
+            {
+                int fd = events[i].data.fd;
+                if (fd == listener)
+                    acceptAll();
+                else if (connections[fd] && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+                    readFrom(fd);
+            }
+            if (!touched.empty() && !system.syncJournal())
+                return false; // Never acknowledge what is not durable
+            for (int fd : touched)
+            {
+                if (connections[fd])
+                    writeTo(fd);
+            }
+            for (int i = 0; i < count; i++)
+            {
+                int fd = events[i].data.fd;
+                if (fd != listener && (events[i].events & EPOLLOUT) && (size_t)fd < connections.size() && connections[fd])
+                    writeTo(fd);
+            }
         }
+        return true;
     }
 
-    bool isValidPhoneNumber(const string &mobile)
+    size_t connectionsAccepted() const { return accepted; }
+};
+
+// Load generator (run with --load-client address [connections [requests
+// [pipeline depth]]]): each connection books, queries and checks seats on a
+// show of its own, keeping up to `depth` requests in flight, all driven from
+// one epoll loop. Reports throughput and reply latency.
+int runLoadClient(const string &address, int connectionCount, int requestsEach, int depth)
+{
+    sockaddr_storage storage;
+    socklen_t length;
+    if (!parseAddress(address, storage, length))
     {
-        if (mobile.length() != 10)
-            return false;
-        return all_of(mobile.begin(), mobile.end(), ::isdigit);
+        cerr << "Bad address " << address << endl;
+        return 1;
     }
+    using Clock = chrono::steady_clock;
+    struct Client
+    {
+        int fd;
+        int sent = 0, received = 0;
+        string out, in;
+        size_t written = 0;
+        bool wantsOut = false; // EPOLLOUT is requested
+        vector<Clock::time_point> sentAt;
+        string name, mobile, title;
+    };
 
-    void run_choice_2()
-    { // Book Ticket
-        string name, mobile, title, time;
-        int seat;
-        vector<int> seats;
-        cout << "Enter name: ";
-        cin.ignore();
-        getline(cin, name);
-        cout << "Enter mobile: ";
-        cin >> mobile;
-        while (!isValidPhoneNumber(mobile))
+    // One show per run, big enough that every booking can succeed
+    string title = "Load Test " + to_string(chrono::system_clock::now().time_since_epoch().count() % 1000000000);
+    int seatsNeeded = connectionCount * requestsEach;
+
+    int poller = epoll_create1(EPOLL_CLOEXEC);
+    vector<Client> clients(connectionCount);
+    for (int c = 0; c < connectionCount; c++)
+    {
+        Client &client = clients[c];
+        client.fd = socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (client.fd < 0 || connect(client.fd, (sockaddr *)&storage, length) != 0)
         {
-            cout << "Please enter a valid phone number: ";
-            cin >> mobile;
+            cerr << "Cannot connect to " << address << " (connection " << c << ")" << endl;
+            return 1;
         }
-        cout << "Enter movie title: ";
-        cin.ignore();
-        getline(cin, title);
-        cout << "Enter movie timing: ";
-        getline(cin, time);
+        int one = 1;
+        setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(client.fd, F_SETFL, O_NONBLOCK);
+        client.name = "Kiosk " + to_string(c);
+        client.mobile = to_string(7000000000LL + c);
+        client.sentAt.resize(requestsEach + 1);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u32 = c;
+        epoll_ctl(poller, EPOLL_CTL_ADD, client.fd, &event);
+    }
 
-        if (getMovie(title, time) == nullptr)
+    auto request = [&](int c, int i) -> string
+    {
+        Client &client = clients[c];
+        int seat = c * requestsEach + i + 1;
+        switch (i % 4)
         {
-            cout << "Movie or timing not found.\n";
-            return;
+        case 0:
+        case 1:
+            return "BOOK|" + client.name + "|" + client.mobile + "|" + title + "|12:00 PM|" + to_string(seat) + "\n";
+        case 2:
+            return "QUERY|" + client.name + "|" + client.mobile + "|" + title + "\n";
+        default:
+            return "SEATS|" + title + "|12:00 PM\n";
         }
-        showAvailableSeats(title, time);
+    };
 
-        cout << "Enter seat numbers (end with -1): ";
-        while (cin >> seat && seat != -1)
-            seats.push_back(seat);
-        bookTicket(name, mobile, title, time, seats);
+    bool showReady = false;
+    // Tops up the pipeline and writes what the socket takes. EPOLLOUT is
+    // requested only while output is left over, so epoll_wait can block
+    auto pump = [&](int c)
+    {
+        Client &client = clients[c];
+        while (showReady && client.sent < requestsEach && client.sent - client.received < depth)
+        {
+            client.sentAt[client.sent % (requestsEach + 1)] = Clock::now();
+            client.out += request(c, client.sent++);
+        }
+        while (client.written < client.out.size())
+        {
+            ssize_t n = write(client.fd, client.out.data() + client.written, client.out.size() - client.written);
+            if (n <= 0)
+                break;
+            client.written += n;
+        }
+        if (client.written == client.out.size())
+        {
+            client.out.clear();
+            client.written = 0;
+        }
+        if (client.wantsOut != !client.out.empty())
+        {
+            client.wantsOut = !client.out.empty();
+            epoll_event event = {};
+            event.events = EPOLLIN | (client.wantsOut ? uint32_t(EPOLLOUT) : 0u);
+            event.data.u32 = c;
+            epoll_ctl(poller, EPOLL_CTL_MOD, client.fd, &event);
+        }
+    };
+
+    // The first connection creates the show before anyone books
+    clients[0].out = "MOVIE|" + title + "|12:00 PM|10|" + to_string(seatsNeeded) + "\n";
+    clients[0].sentAt[0] = Clock::now();
+    pump(0);
+
+    vector<float> latencies;
+    latencies.reserve(size_t(connectionCount) * requestsEach);
+    size_t okReplies = 0, errorReplies = 0;
+    int finished = 0;
+    auto start = Clock::now();
+    epoll_event events[1024];
+    while (finished < connectionCount)
+    {
+        int count = epoll_wait(poller, events, 1024, 1000);
+        if (count == 0)
+        {
+            cerr << "Server stopped answering\n";
+            return 1;
+        }
+        for (int e = 0; e < count; e++)
+        {
+            int c = events[e].data.u32;
+            Client &client = clients[c];
+            char buffer[1 << 16];
+            ssize_t n;
+            while ((n = read(client.fd, buffer, sizeof(buffer))) > 0)
+                client.in.append(buffer, n);
+            if (n == 0)
+            {
+                cerr << "Server closed the connection\n";
+                return 1;
+            }
+            size_t start = 0, end;
+            while ((end = client.in.find('\n', start)) != string::npos)
+            {
+                Clock::time_point sentAt = client.sentAt[client.received % (requestsEach + 1)];
+                latencies.push_back(chrono::duration<float, micro>(Clock::now() - sentAt).count());
+                (client.in.compare(start, 2, "OK") == 0 ? okReplies : errorReplies)++;
+                client.received++;
+                start = end + 1;
+                if (c == 0 && !showReady)
+                {
+                    showReady = true; // The MOVIE reply: everyone else can start
+                    client.received = 0;
+                    latencies.pop_back();
+                    okReplies--;
+                    for (int other = 1; other < connectionCount; other++)
+                        pump(other);
+                }
+            }
+            client.in.erase(0, start);
+            if (client.received == requestsEach && client.sent == requestsEach)
+            {
+                epoll_ctl(poller, EPOLL_CTL_DEL, client.fd, nullptr);
+                finished++;
+                continue;
+            }
+            pump(c);
+        }
     }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+    for (Client &client : clients)
+        close(client.fd);
+    close(poller);
 
-    void run_choice_3()
-    { // Cancel Ticket
-        string name, mobile, title;
-        int seat;
-        vector<int> seats;
-        cout << "Enter name: ";
-        cin.ignore();
-        getline(cin, name);
-        cout << "Enter mobile: ";
-        cin >> mobile;
-        while (!isValidPhoneNumber(mobile))
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p)
+    { return latencies.empty() ? 0.0 : latencies[min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+    cout << connectionCount << " connections x " << requestsEach << " requests, pipeline depth " << depth << ": "
+         << fixed << setprecision(0) << latencies.size() / seconds << " requests/s, " << okReplies << " OK, "
+         << errorReplies << " ERR; latency p50 " << percentile(0.5) << " us, p99 " << percentile(0.99) << " us\n";
+    return errorReplies == 0 ? 0 : 1;
+}
+#endif
+
+bool fileExists(const string &path)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file)
+        fclose(file);
+    return file != nullptr;
+}
+
+// Whole contents of a file, or of stdin when path is "-"
+bool readAll(const char *path, string &text)
+{
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (!in)
+        return false;
+    char buffer[1 << 16];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        text.append(buffer, n);
+    if (in != stdin)
+        fclose(in);
+    return true;
+}
+
+void addSampleMovies(BookingSystem &system)
+{
+    system.addMovie("Avengers", "10:00 AM", 10.0);
+    system.addMovie("Inception", "9:00 AM", 12.0);
+    system.addMovie("Interstellar", "8:00 AM", 15.0);
+    system.addMovie("The Dark Knight", "7:00 AM", 8.0);
+}
+
+// Starts from the snapshot and replays its journal, or from the sample movies
+// when there is no snapshot yet; with no snapshot path nothing is persisted
+bool openState(BookingSystem &system, Journal &journal, const string &snapshot)
+{
+    if (snapshot.empty() || !Snapshot::load(snapshot, system))
+    {
+        if (!snapshot.empty() && fileExists(snapshot))
         {
-            cout << "Please enter a valid phone number: ";
-            cin >> mobile;
+            cerr << "Cannot load " << snapshot << endl;
+            return false;
         }
-        cout << "Enter movie title: ";
-        cin.ignore();
-        getline(cin, title);
-        Ticket *ticket = getTicket(name, mobile, title);
-        if (ticket == nullptr)
+        addSampleMovies(system);
+    }
+    if (!snapshot.empty())
+    {
+        // Changes since the snapshot are in its journal
+        uint64_t covered = system.journalSequence();
+        if (!journal.open(snapshot + ".journal", covered, [&](const Journal::Record &record)
+                          { if (record.sequence > covered) system.replay(record); }))
         {
-            cout << "Ticket not found.\n";
-            return;
+            cerr << "Cannot open " << snapshot << ".journal: " << journal.error() << endl;
+            return false;
         }
+        system.attachJournal(&journal);
+    }
+    return true;
+}
 
-        ticket->displayBookedSeats();
-        cout << "Enter seat numbers to cancel (end with -1): ";
-        while (cin >> seat && seat != -1)
-            seats.push_back(seat);
-        cancelTicket(name, mobile, title, seats);
+// Saves the final state and empties the journal it replaces
+bool saveState(BookingSystem &system, Journal &journal, const string &snapshot)
+{
+    if (snapshot.empty())
+        return true;
+    if (!Snapshot::write(Snapshot::capture(system), snapshot))
+    {
+        cerr << "Cannot write " << snapshot << endl;
+        return false;
     }
+    journal.truncate(); // The snapshot now covers all of it
+    return true;
+}
 
-    void run_choice_4()
-    { // Show Available Seats
-        cout << "Enter the movie title: ";
-        string title;
-        cin.ignore();
-        getline(cin, title);
-        cout << "Enter the movie timing: ";
-        string time;
-        getline(cin, time);
-        showAvailableSeats(title, time);
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--batch")
+    {
+        // --batch [commands [snapshot]]: starts from the snapshot when there is
+        // one and saves the final state back to it
+        string text;
+        if (!readAll(argc > 2 ? argv[2] : "-", text))
+        {
+            cerr << "Cannot read " << argv[2] << endl;
+            return 1;
+        }
+        BookingSystem system;
+        Journal journal;
+        string snapshot = argc > 3 ? argv[3] : "";
+        if (!openState(system, journal, snapshot))
+            return 1;
+        BatchRunner runner(system);
+        runner.runAll(text);
+        cerr << runner.commandCount() << " commands, " << runner.failureCount() << " failed\n";
+        return saveState(system, journal, snapshot) ? 0 : 1;
+    }
+#ifdef __linux__
+    if (argc > 2 && string(argv[1]) == "--serve")
+    {
+        // --serve address [snapshot]: address is host:port or a socket path
+        BookingSystem system;
+        Journal journal;
+        string snapshot = argc > 3 ? argv[3] : "";
+        if (!openState(system, journal, snapshot))
+            return 1;
+        BatchRunner runner(system);
+        BookingServer server(runner, system);
+        if (!server.listenOn(argv[2]))
+        {
+            cerr << "Cannot listen on " << argv[2] << endl;
+            return 1;
+        }
+        signal(SIGPIPE, SIG_IGN);
+        signal(SIGINT, [](int)
+               { stopServer = 1; });
+        signal(SIGTERM, [](int)
+               { stopServer = 1; });
+        cerr << "Serving on " << argv[2] << endl;
+        bool ok = server.run();
+        cerr << server.connectionsAccepted() << " connections, " << runner.commandCount() << " requests, "
+             << runner.failureCount() << " failed\n";
+        return ok && saveState(system, journal, snapshot) ? 0 : 1;
+    }
+    if (argc > 2 && string(argv[1]) == "--load-client")
+    {
+        return runLoadClient(argv[2], argc > 3 ? atoi(argv[3]) : 100, argc > 4 ? atoi(argv[4]) : 1000,
+                             argc > 5 ? atoi(argv[5]) : 16);
+    }
+#endif
+    if (argc > 1 && string(argv[1]) == "--snapshot-bench")
+    {
+        return runSnapshotBenchmark();
+    }
+    if (argc > 1 && string(argv[1]) == "--journal-bench")
+    {
+        return runJournalBenchmark();
+    }
+    if (argc > 1 && string(argv[1]) == "--seat-check")
+    {
+        return runSeatSetCheck();
+    }
+    if (argc > 1 && string(argv[1]) == "--shard-bench")
+    {
+        return runShardBenchmark(argc > 2 ? min(64, max(1, atoi(argv[2]))) : 64);
     }
 
-    void run_choice_5()
-    { // Retrieve Ticket
-        string name, mobile, title;
-        cout << "Enter name: ";
-        cin.ignore();
-        getline(cin, name);
-        cout << "Enter movie title: ";
-        getline(cin, title);
-        cout << "Enter mobile: ";
-        cin >> mobile;
-        retrieveTicket(name, title, mobile);
+    // Console bookings persist only with --state snapshot, through the
+    // snapshot and its journal like batch ones; anything else is a mistake
+    string snapshot;
+    if (argc == 3 && string(argv[1]) == "--state")
+        snapshot = argv[2];
+    else if (argc > 1)
+    {
+        cerr << "Unknown arguments. Usage: " << argv[0] << " [--state snapshot]\n"
+             << "       " << argv[0] << " --batch [commands [snapshot]] | --serve address [snapshot]\n"
+             << "       " << argv[0] << " --load-client address [clients [requests [pipeline]]]\n"
+             << "       " << argv[0] << " --snapshot-bench | --journal-bench | --seat-check | --shard-bench [threads]\n";
+        return 1;
     }
-};
 
-int main()
-{
 #ifndef ONLINE_JUDGE
     freopen("input.txt", "r", stdin);
     freopen("output.txt", "w", stdout);
 #endif
     BookingSystem system;
-    system.addMovie("Avengers", "10:00 AM", 10.0);
-    system.addMovie("Inception", "9:00 AM", 12.0);
-    system.addMovie("Interstellar", "8:00 AM", 15.0);
-    system.addMovie("The Dark Knight", "7:00 AM", 8.0);
+    Journal journal;
+    if (!openState(system, journal, snapshot))
+        return 1;
     system.showMovies();
 
     int choice;
@@ -439,7 +3316,7 @@ int main()
         default:
             cout << "Invalid choice, please try again.\n";
         }
-    } while (choice != 6);
+    } while (choice != 6 && cin);
 
-    return 0;
+    return saveState(system, journal, snapshot) ? 0 : 1;
 }